@@ -0,0 +1,203 @@
+/*
+ * batchX.c - Copyright 2014-25 Andre M. Maree / KSS Technologies (Pty) Ltd.
+ *
+ * NDJSON batches, records located by a string aware newline scan and then parsed in parallel.
+ * Workers claim records in chunks from a shared counter, each worker owns a parse handler whose
+ * token arena is retained across records and batches.
+ */
+
+#include "hal_platform.h"
+#include "batchX.h"
+#include "syslog.h"
+#include "errors_events.h"
+#include "swarX.h"
+
+#include <pthread.h>
+#include <string.h>
+
+// ############################### BUILD: debug configuration options ##############################
+
+#define	debugFLAG					0xF000
+#define	debugTIMING					(debugFLAG_GLOBAL & debugFLAG & 0x1000)
+#define	debugTRACK					(debugFLAG_GLOBAL & debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG_GLOBAL & debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG_GLOBAL & debugFLAG & 0x8000)
+
+// ############################################ structures #########################################
+
+typedef struct json_worker_t {
+	json_batch_t * psB;
+	parse_hdlr_t * psPH;
+	ph_entries_t * psEntries;							// private copy, pxVar rebased per record
+	pthread_t Thread;
+} json_worker_t;
+
+// ####################################### Local Functions #########################################
+
+/**
+ * @brief	find the first occurrence of any of the 3 characters, 8 bytes at a time
+ * @return	pointer to character found or pcEnd
+ */
+static const char * pcJsonBatchFind(const char * pcNow, const char * pcEnd, char c1, char c2, char c3) {
+	for (; (pcEnd - pcNow) >= 8; pcNow += 8) {
+		uint64_t u64 = swarLoad(pcNow);
+		if (swarHAS_BYTE(u64, c1) | swarHAS_BYTE(u64, c2) | swarHAS_BYTE(u64, c3))
+			break;
+	}
+	while (pcNow < pcEnd && *pcNow != c1 && *pcNow != c2 && *pcNow != c3)
+		++pcNow;
+	return pcNow;
+}
+
+/**
+ * @brief	find the end of the record starting at pcNow, ie '\n' not inside a string
+ * @note	A raw '\n' is never valid inside a string, so it always ends the record. An unterminated
+ *			string then only invalidates its own record, the next record starts in sync.
+ */
+static const char * pcJsonBatchEOR(const char * pcNow, const char * pcEnd) {
+	while (1) {
+		pcNow = pcJsonBatchFind(pcNow, pcEnd, '\n', CHR_DOUBLE_QUOTE, CHR_DOUBLE_QUOTE);
+		if (pcNow == pcEnd || *pcNow == '\n')
+			return pcNow;
+		++pcNow;										// opening quote, skip string with escapes
+		while (1) {
+			pcNow = pcJsonBatchFind(pcNow, pcEnd, CHR_DOUBLE_QUOTE, CHR_BACKSLASH, '\n');
+			if (pcNow == pcEnd || *pcNow == '\n')
+				return pcNow;
+			if (*pcNow++ == CHR_DOUBLE_QUOTE)
+				break;
+			if (pcNow < pcEnd && *pcNow != '\n')		// escaped character
+				++pcNow;
+		}
+	}
+}
+
+static void vJsonBatchRecord(json_worker_t * psW, size_t Rec) {
+	json_batch_t * psB = psW->psB;
+	json_rec_t * psRec = &psB->psRecs[Rec];
+	parse_hdlr_t * psPH = psW->psPH;
+	psPH->pcBuf = psRec->pcRec;
+	psPH->szBuf = psRec->szRec;
+	psRec->Found = 0;
+	psRec->iRV = xJsonParse(psPH);
+	if (psRec->iRV <= 0)
+		return;
+	if (psW->psEntries) {
+		for (int e = 0; e < psB->psEntries->Count; ++e)
+			psW->psEntries->Entry[e].pxVar.pv = (u8_t *) psB->psEntries->Entry[e].pxVar.pv + (Rec * psB->szStride);
+		psRec->Found = xJsonParseEntries(psPH, psW->psEntries);
+	}
+	if (psB->hdlrRec)
+		psRec->iRV = psB->hdlrRec(psPH, psRec, Rec);
+}
+
+static void * pvJsonBatchWorker(void * pvArg) {
+	json_worker_t * psW = pvArg;
+	json_batch_t * psB = psW->psB;
+	while (1) {
+		size_t Rec = __atomic_fetch_add(&psB->NextRec, jsonBATCH_CHUNK, __ATOMIC_RELAXED);
+		if (Rec >= psB->NumRec)
+			break;
+		size_t Last = (Rec + jsonBATCH_CHUNK < psB->NumRec) ? Rec + jsonBATCH_CHUNK : psB->NumRec;
+		for (; Rec < Last; ++Rec)
+			vJsonBatchRecord(psW, Rec);
+	}
+	return NULL;
+}
+
+// ####################################### Global Functions ########################################
+
+size_t xJsonBatchSplit(const char * pcBuf, size_t szBuf, json_rec_t * psRecs, size_t MaxRec) {
+	const char * pcNow = pcBuf;
+	const char * pcEnd = pcBuf + szBuf;
+	size_t NumRec = 0;
+	while (pcNow < pcEnd) {
+		while (pcNow < pcEnd && (*pcNow == ' ' || *pcNow == '\t' || *pcNow == '\r' || *pcNow == '\n'))
+			++pcNow;									// leading white space & blank lines
+		if (pcNow == pcEnd || *pcNow == 0)
+			break;
+		const char * pcEOR = pcJsonBatchEOR(pcNow, pcEnd);
+		if (psRecs && NumRec < MaxRec) {
+			psRecs[NumRec].pcRec = pcNow;
+			psRecs[NumRec].szRec = pcEOR - pcNow;
+		}
+		++NumRec;
+		pcNow = pcEOR;
+	}
+	return NumRec;
+}
+
+int xJsonBatchParse(json_batch_t * psB) {
+	IF_myASSERT(debugPARAM, psB->psRecs || psB->NumRec == 0);
+	int NumThreads = psB->NumThreads;
+	if (NumThreads < 1)
+		NumThreads = 1;
+	if ((size_t) NumThreads > (psB->NumRec + jsonBATCH_CHUNK - 1) / jsonBATCH_CHUNK)
+		NumThreads = (psB->NumRec + jsonBATCH_CHUNK - 1) / jsonBATCH_CHUNK;	// no idle workers
+	if (NumThreads > jsonBATCH_MAX_THREADS)
+		NumThreads = jsonBATCH_MAX_THREADS;
+	if (NumThreads == 0)
+		return 0;
+	if (NumThreads > psB->NumPH) {						// add parse handlers, existing arenas retained
+		parse_hdlr_t * psNew = realloc(psB->psPH, NumThreads * sizeof(parse_hdlr_t));
+		if (psNew == NULL)
+			return erFAILURE;
+		for (int i = psB->NumPH; i < NumThreads; ++i)
+			vJsonParseInit(&psNew[i], NULL, 0);
+		psB->psPH = psNew;
+		psB->NumPH = NumThreads;
+	}
+	json_worker_t * psW = calloc(NumThreads, sizeof(json_worker_t));	// sized by workers, not on the stack
+	if (psW == NULL)
+		return erFAILURE;
+	size_t szEntries = psB->psEntries ? sizeof(ph_entries_t) + psB->psEntries->Count * sizeof(ph_entry_t) : 0;
+	if (szEntries && xJsonEntriesBuild(psB->psEntries) != erSUCCESS) {	// key set shared by the copies
+		free(psW);
+		return erFAILURE;
+	}
+	int iRV = erSUCCESS, Started = 0;
+	for (int i = 0; i < NumThreads; ++i) {
+		psW[i].psB = psB;
+		psW[i].psPH = &psB->psPH[i];
+		psW[i].psPH->pvArg = psB->pvArg;
+		psW[i].psEntries = NULL;
+		if (szEntries) {
+			psW[i].psEntries = malloc(szEntries);
+			if (psW[i].psEntries == NULL) {
+				NumThreads = i;
+				iRV = erFAILURE;
+				break;
+			}
+			memcpy(psW[i].psEntries, psB->psEntries, szEntries);
+		}
+	}
+	psB->NextRec = 0;
+	if (iRV == erSUCCESS) {								// caller is worker 0
+		for (Started = 1; Started < NumThreads; ++Started) {
+			if (pthread_create(&psW[Started].Thread, NULL, pvJsonBatchWorker, &psW[Started]) != 0) {
+				SL_ERR("Only %d of %d workers started", Started, NumThreads);
+				break;									// those started share the work
+			}
+		}
+		pvJsonBatchWorker(&psW[0]);
+		for (int i = 1; i < Started; ++i)
+			pthread_join(psW[i].Thread, NULL);
+	}
+	for (int i = 0; i < NumThreads; ++i)
+		free(psW[i].psEntries);
+	free(psW);
+	if (iRV < erSUCCESS)
+		return iRV;
+	int NumOK = 0;
+	for (size_t Rec = 0; Rec < psB->NumRec; ++Rec)
+		NumOK += (psB->psRecs[Rec].iRV > 0);
+	return NumOK;
+}
+
+void vJsonBatchRelease(json_batch_t * psB) {
+	for (int i = 0; i < psB->NumPH; ++i)
+		vJsonParseRelease(&psB->psPH[i]);
+	free(psB->psPH);
+	psB->psPH = NULL;
+	psB->NumPH = 0;
+}
@@ -0,0 +1,73 @@
+// batchX.h - newline delimited (NDJSON) batch parsing on a pool of worker threads
+
+#pragma once
+
+#include "parserX.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ########################################## macros ###############################################
+
+#define	jsonBATCH_CHUNK				16					// records claimed per worker step
+#define	jsonBATCH_MAX_THREADS		64
+
+// ############################################ structures #########################################
+
+typedef struct json_rec_t {
+	const char * pcRec;									// start of record in source
+	size_t szRec;										// length of record, excl '\n'
+	int iRV;											// xJsonParse() result or record handler return value
+	u64_t Found;										// entries parsed, bit N = Entry[N]
+} json_rec_t;
+
+/**
+ * @brief	record handler, called on a worker thread after a record parsed successfully
+ * @param	psPH - parse handler of the worker, pvArg as per json_batch_t
+ * @param	psRec - record, Found already set if entries supplied
+ * @param	Rec - index of the record
+ * @return	stored as the record iRV
+ */
+typedef int (* json_rec_hdlr_t)(parse_hdlr_t * psPH, json_rec_t * psRec, size_t Rec);
+
+typedef struct json_batch_t {
+	json_rec_t * psRecs;								// records, as located by xJsonBatchSplit()
+	size_t NumRec;
+	json_rec_hdlr_t hdlrRec;							// optional per record handler
+	ph_entries_t * psEntries;							// optional per record extraction, pxVar addresses record 0
+	size_t szStride;									// distance between destinations of successive records
+	void * pvArg;										// passed to handler via psPH->pvArg
+	int NumThreads;										// workers incl caller, 0 or 1 = caller only
+	// private, retained across batches
+	parse_hdlr_t * psPH;								// per worker parse handlers (token arenas)
+	int NumPH;
+	size_t NextRec;										// next record to be claimed
+} json_batch_t;
+
+// ####################################### global functions ########################################
+
+/**
+ * @brief	Locate records, split at '\n' outside of strings, blank lines skipped
+ * @param	psRecs - array of MaxRec records to fill in, NULL to only count
+ * @return	number of records in the buffer, only the first MaxRec stored
+ * @note	A raw '\n' inside a string (invalid JSON) also ends the record, so an unterminated
+ *			string never swallows the records following it
+ */
+size_t xJsonBatchSplit(const char * pcBuf, size_t szBuf, json_rec_t * psRecs, size_t MaxRec);
+
+/**
+ * @brief	Parse all records, each with its own parse handler, optionally extract entries & call handler
+ * @return	number of records with iRV > 0, or erFAILURE if memory or threads not available
+ * @note	Records are independent, handler & entry destinations must not be shared between records
+ */
+int xJsonBatchParse(json_batch_t * psB);
+
+/**
+ * @brief	Free the per worker parse handlers
+ */
+void vJsonBatchRelease(json_batch_t * psB);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,257 @@
+/*
+ * cacheX.c - Copyright 2014-25 Andre M. Maree / KSS Technologies (Pty) Ltd.
+ *
+ * Source files are mapped, not read. The tokens & key index of the last parse are kept in a
+ * sidecar file, keyed by source size & content hash, and mapped directly when still valid.
+ */
+
+#include "hal_platform.h"
+#include "cacheX.h"
+#include "syslog.h"
+#include "errors_events.h"
+
+#if (jsonCACHE == 1)
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ############################### BUILD: debug configuration options ##############################
+
+#define	debugFLAG					0xF000
+#define	debugTIMING					(debugFLAG_GLOBAL & debugFLAG & 0x1000)
+#define	debugTRACK					(debugFLAG_GLOBAL & debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG_GLOBAL & debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG_GLOBAL & debugFLAG & 0x8000)
+
+#define	jsonCACHE_ALIGN(x)			(((x) + 7) & ~(size_t) 7)
+
+// XXH64 primes
+#define	jsonXXH_P1					0x9E3779B185EBCA87ULL
+#define	jsonXXH_P2					0xC2B2AE3D27D4EB4FULL
+#define	jsonXXH_P3					0x165667B19E3779F9ULL
+#define	jsonXXH_P4					0x85EBCA77C2B2AE63ULL
+#define	jsonXXH_P5					0x27D4EB2F165667C5ULL
+
+// ####################################### Local Functions #########################################
+
+static inline u64_t xJsonRotl64(u64_t X, int R) { return (X << R) | (X >> (64 - R)); }
+
+static inline u64_t xJsonXxhRound(u64_t Acc, u64_t Word) {
+	return xJsonRotl64(Acc + Word * jsonXXH_P2, 31) * jsonXXH_P1;
+}
+
+/**
+ * @brief	map a complete file, copy-on-write if fWrite
+ * @return	mapping or NULL if not possible (incl empty file)
+ */
+static void * pvJsonFileMap(const char * pcPath, size_t * pszMap, int fWrite) {
+	int fd = open(pcPath, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	struct stat sStat;
+	void * pvMap = NULL;
+	if (fstat(fd, &sStat) == 0 && sStat.st_size > 0) {
+		pvMap = mmap(NULL, sStat.st_size, fWrite ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_PRIVATE, fd, 0);
+		if (pvMap == MAP_FAILED)
+			pvMap = NULL;
+		*pszMap = sStat.st_size;
+	}
+	close(fd);
+	return pvMap;
+}
+
+/**
+ * @brief	offsets of the token & index arrays, expected size of the cache
+ */
+static size_t xJsonCacheSize(const json_cache_hdr_t * psH, size_t * pszIdx) {
+	*pszIdx = jsonCACHE_ALIGN(sizeof(json_cache_hdr_t) + (psH->NumTok + jsonEXTRA_SIZE) * sizeof(jsontok_t));
+	return *pszIdx + (psH->MaskIdx ? (psH->MaskIdx + 1) * sizeof(int) : 0);
+}
+
+/**
+ * @brief	check mapped tokens & index slots are in range, a damaged cache must not be trusted
+ * @return	1 if all in range else 0
+ */
+static int xJsonCacheValid(const json_cache_hdr_t * psH, const jsontok_t * psT0, const int * piIdx) {
+	for (int i = 0; i < psH->NumTok; ++i) {
+		const jsontok_t * psT = &psT0[i];
+		int Start = psT->start, End = psT->end, Size = psT->size;	// signed with jsmn, u16 if compact
+		if ((psT->type != JSMN_OBJECT && psT->type != JSMN_ARRAY && psT->type != JSMN_STRING && psT->type != JSMN_PRIMITIVE) ||
+			Start < 0 || Start > End || (u64_t) End > psH->szSrc || Size < 0 || Size >= (psH->NumTok - i))
+			return 0;
+	#if (jsonTOKEN_COMPACT == 1 && jsonTOKEN_PARENT == 1)
+		if (psT->parent != jsonTOK_UNSET && psT->parent >= i)
+			return 0;
+	#elif (jsonTOKEN_COMPACT == 0 && defined(JSMN_PARENT_LINKS))
+		if (psT->parent < -1 || psT->parent >= i)
+			return 0;
+	#endif
+	}
+	for (int i = psH->NumTok; i < psH->NumTok + jsonEXTRA_SIZE; ++i) {
+		if (psT0[i].type != JSMN_UNDEFINED)				// spare tokens zeroed, end markers
+			return 0;
+	}
+	if (psH->MaskIdx == 0)
+		return 1;
+	int NumUsed = 0;
+	for (int i = 0; i <= psH->MaskIdx; ++i) {
+		if (piIdx[i] < 0)
+			continue;
+		if (piIdx[i] >= psH->NumTok - 1)				// key token, value must follow
+			return 0;
+		++NumUsed;
+	}
+	return NumUsed <= psH->MaskIdx;						// a free slot remains, probes terminate
+}
+
+/**
+ * @brief	attach tokens & index of a mapped cache if valid for the source
+ * @return	number of tokens or erFAILURE if cache missing, stale or different layout
+ */
+static int xJsonCacheAttach(json_file_t * psF, const char * pcCache, u64_t Hash, int fIndex) {
+	psF->pvCache = pvJsonFileMap(pcCache, &psF->szCache, 1);
+	if (psF->pvCache == NULL)
+		return erFAILURE;
+	json_cache_hdr_t * psH = psF->pvCache;
+	size_t szIdx;
+	if (psF->szCache < sizeof(json_cache_hdr_t) || psH->Magic != jsonCACHE_MAGIC ||
+		psH->Version != jsonCACHE_VERSION || psH->szTok != sizeof(jsontok_t) ||
+		psH->Config != jsonCACHE_CONFIG || psH->szSrc != psF->szSrc || psH->Hash != Hash ||
+		psH->NumTok <= 0 || (size_t) psH->NumTok > psF->szCache / sizeof(jsontok_t) ||
+		psH->MaskIdx < 0 || (psH->MaskIdx & (psH->MaskIdx + 1)) ||		// 0 or (power of 2) - 1
+		(psH->MaskIdx && (size_t) psH->MaskIdx >= psF->szCache / sizeof(int)) ||
+		(fIndex && psH->NumTok >= jsonINDEX_MIN_TOKENS && psH->MaskIdx == 0) ||
+		xJsonCacheSize(psH, &szIdx) != psF->szCache ||
+		xJsonCacheValid(psH, (jsontok_t *) (psH + 1), (int *) ((u8_t *) psF->pvCache + szIdx)) == 0) {
+		munmap(psF->pvCache, psF->szCache);
+		psF->pvCache = NULL;
+		return erFAILURE;
+	}
+	parse_hdlr_t * psPH = &psF->sPH;
+	psPH->psT0 = (jsontok_t *) (psH + 1);
+	psPH->MaxTok = psH->NumTok + jsonEXTRA_SIZE;
+	psPH->NumTok = psPH->sParser.toknext = psH->NumTok;
+	psPH->sParser.pos = psF->szSrc;
+	psPH->piIdx = psH->MaskIdx ? (int *) ((u8_t *) psF->pvCache + szIdx) : NULL;
+	psPH->szIdx = 0;									// not ours, never grown or freed
+	psPH->MaskIdx = psH->MaskIdx;
+	psPH->fMapped = 1;
+	return psH->NumTok;
+}
+
+/**
+ * @brief	write tokens & index to the cache, via a temporary file renamed into place
+ */
+static void vJsonCacheWrite(json_file_t * psF, const char * pcCache, u64_t Hash) {
+	parse_hdlr_t * psPH = &psF->sPH;
+	json_cache_hdr_t sH = {
+		.Magic = jsonCACHE_MAGIC, .Version = jsonCACHE_VERSION, .szTok = sizeof(jsontok_t),
+		.szSrc = psF->szSrc, .Hash = Hash, .NumTok = psPH->NumTok, .MaskIdx = psPH->MaskIdx,
+		.Config = jsonCACHE_CONFIG,
+	};
+	size_t szIdx, szPad;
+	xJsonCacheSize(&sH, &szIdx);
+	szPad = szIdx - sizeof(sH) - (sH.NumTok + jsonEXTRA_SIZE) * sizeof(jsontok_t);
+	char caTemp[PATH_MAX];
+	if (snprintf(caTemp, sizeof(caTemp), "%s.XXXXXX", pcCache) >= (int) sizeof(caTemp))
+		return;											// path too long for a temp name
+	int fd = mkstemp(caTemp);							// unique per writer, threads & processes
+	if (fd < 0)
+		return;											// read only location, not an error
+	fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);	// no more private than the source
+	FILE * psFile = fdopen(fd, "wb");
+	if (psFile == NULL) {
+		close(fd);
+		unlink(caTemp);
+		return;
+	}
+	static const u8_t u8Pad[8];
+	int fOK = fwrite(&sH, sizeof(sH), 1, psFile) == 1 &&
+		fwrite(psPH->psT0, sizeof(jsontok_t), sH.NumTok + jsonEXTRA_SIZE, psFile) == (size_t) (sH.NumTok + jsonEXTRA_SIZE) &&
+		fwrite(u8Pad, 1, szPad, psFile) == szPad &&
+		(sH.MaskIdx == 0 || fwrite(psPH->piIdx, sizeof(int), sH.MaskIdx + 1, psFile) == (size_t) (sH.MaskIdx + 1));
+	fOK = (fclose(psFile) == 0) && fOK;
+	if (fOK == 0 || rename(caTemp, pcCache) != 0) {
+		SL_WARN("Cache '%s' not written", pcCache);
+		unlink(caTemp);
+	}
+}
+
+// ####################################### Global Functions ########################################
+
+u64_t xJsonHash64(const void * pvBuf, size_t szBuf) {
+	const u8_t * pu8 = pvBuf, * pu8End = pu8 + szBuf;
+	u64_t Hash, Word;
+	if (szBuf >= 32) {									// 4 independent lanes of 8 bytes per step
+		u64_t V[4] = { jsonXXH_P1 + jsonXXH_P2, jsonXXH_P2, 0, -jsonXXH_P1 };
+		do {
+			for (int i = 0; i < 4; ++i, pu8 += 8) {
+				memcpy(&Word, pu8, 8);
+				V[i] = xJsonXxhRound(V[i], Word);
+			}
+		} while ((pu8End - pu8) >= 32);
+		Hash = xJsonRotl64(V[0], 1) + xJsonRotl64(V[1], 7) + xJsonRotl64(V[2], 12) + xJsonRotl64(V[3], 18);
+		for (int i = 0; i < 4; ++i)
+			Hash = (Hash ^ xJsonXxhRound(0, V[i])) * jsonXXH_P1 + jsonXXH_P4;
+	} else {
+		Hash = jsonXXH_P5;
+	}
+	Hash += szBuf;
+	for (; (pu8End - pu8) >= 8; pu8 += 8) {
+		memcpy(&Word, pu8, 8);
+		Hash = xJsonRotl64(Hash ^ xJsonXxhRound(0, Word), 27) * jsonXXH_P1 + jsonXXH_P4;
+	}
+	if ((pu8End - pu8) >= 4) {
+		u32_t Half;
+		memcpy(&Half, pu8, 4);
+		Hash = xJsonRotl64(Hash ^ (Half * jsonXXH_P1), 23) * jsonXXH_P2 + jsonXXH_P3;
+		pu8 += 4;
+	}
+	while (pu8 < pu8End)
+		Hash = xJsonRotl64(Hash ^ (*pu8++ * jsonXXH_P5), 11) * jsonXXH_P1;
+	Hash ^= Hash >> 33;									// avalanche
+	Hash *= jsonXXH_P2;
+	Hash ^= Hash >> 29;
+	Hash *= jsonXXH_P3;
+	return Hash ^ (Hash >> 32);
+}
+
+int xJsonFileLoad(json_file_t * psF, const char * pcPath, int fIndex) {
+	memset(psF, 0, sizeof(json_file_t));
+	vJsonParseInit(&psF->sPH, NULL, 0);
+	psF->pvSrc = pvJsonFileMap(pcPath, &psF->szSrc, 1);
+	if (psF->pvSrc == NULL) {
+		SL_ERR("Cannot map '%s'", pcPath);
+		return erFAILURE;
+	}
+	parse_hdlr_t * psPH = &psF->sPH;
+	psPH->pcBuf = psF->pvSrc;
+	psPH->szBuf = psF->szSrc;
+	psPH->fIndex = fIndex ? 1 : 0;
+	char caCache[PATH_MAX];
+	if (snprintf(caCache, sizeof(caCache), "%s" jsonCACHE_SUFFIX, pcPath) >= (int) sizeof(caCache))
+		return xJsonParse(psPH);						// path too long for a sidecar, parse only
+	u64_t Hash = xJsonHash64(psF->pvSrc, psF->szSrc);
+	int iRV = xJsonCacheAttach(psF, caCache, Hash, fIndex);
+	if (iRV > 0)
+		return iRV;
+	iRV = xJsonParse(psPH);
+	if (iRV > 0)
+		vJsonCacheWrite(psF, caCache, Hash);
+	return iRV;
+}
+
+void vJsonFileUnload(json_file_t * psF) {
+	vJsonParseRelease(&psF->sPH);
+	if (psF->pvCache)
+		munmap(psF->pvCache, psF->szCache);
+	if (psF->pvSrc)
+		munmap(psF->pvSrc, psF->szSrc);
+	psF->pvCache = psF->pvSrc = NULL;
+	psF->szCache = psF->szSrc = 0;
+}
+#endif
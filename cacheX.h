@@ -0,0 +1,92 @@
+// cacheX.h - memory mapped document loading with a persisted token (& key index) cache
+
+#pragma once
+
+#include "parserX.h"
+
+#ifndef jsonCACHE
+	#if defined(ESP_PLATFORM)
+		#define	jsonCACHE			0					// no mmap()
+	#else
+		#define	jsonCACHE			1
+	#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ########################################## macros ###############################################
+
+#define	jsonCACHE_SUFFIX			".tok"				// sidecar cache, appended to the source path
+#define	jsonCACHE_MAGIC				0x4A544F4BUL		// "JTOK"
+#define	jsonCACHE_VERSION			3
+
+// tokenizer configuration recorded in the cache, tokens are only valid for the same configuration
+#ifdef JSMN_STRICT
+	#define	jsonCACHE_CFG_STRICT	0x0004
+#else
+	#define	jsonCACHE_CFG_STRICT	0
+#endif
+#ifdef JSMN_PARENT_LINKS
+	#define	jsonCACHE_CFG_LINKS		0x0008
+#else
+	#define	jsonCACHE_CFG_LINKS		0
+#endif
+#define	jsonCACHE_CONFIG			((jsonTOKEN_COMPACT ? 0x0001 : 0) | (jsonTOKEN_PARENT ? 0x0002 : 0) | jsonCACHE_CFG_STRICT | jsonCACHE_CFG_LINKS)
+
+// ############################################ structures #########################################
+
+/**
+ * @brief	sidecar layout: header, NumTok + jsonEXTRA_SIZE tokens, padding to 8, MaskIdx + 1 index slots
+ * @note	Native byte order and token layout, a cache is only valid for the build that wrote it.
+ *			Tokens & index are bounds checked against the source once when attached.
+ */
+typedef struct json_cache_hdr_t {
+	u32_t Magic;
+	u16_t Version;
+	u16_t szTok;										// sizeof(jsontok_t), layout check
+	u64_t szSrc;										// source file size
+	u64_t Hash;											// xJsonHash64() of source content
+	i32_t NumTok;
+	i32_t MaskIdx;										// index slots - 1, 0 if no index
+	u32_t Config;										// jsonCACHE_CONFIG of the writer
+	u32_t Spare;
+} json_cache_hdr_t;
+
+typedef struct json_file_t {
+	parse_hdlr_t sPH;									// pcBuf/szBuf is the mapped source
+	void * pvSrc;										// source mapping
+	size_t szSrc;
+	void * pvCache;										// cache mapping, NULL if tokens parsed
+	size_t szCache;
+} json_file_t;
+
+// ####################################### global functions ########################################
+
+#if (jsonCACHE == 1)
+/**
+ * @brief	64 bit content hash, XXH64 (seed 0) of the buffer, 32 bytes per step
+ */
+u64_t xJsonHash64(const void * pvBuf, size_t szBuf);
+
+/**
+ * @brief	Map a file as the source of psF->sPH, with tokens (& key index) from the sidecar cache
+ * @param	fIndex - 1 to (re)build and persist the key index with the tokens
+ * @return	number of tokens, erFAILURE if file not mapped or parse error (< 0)
+ * @note	Cache is used if source size, content hash, token layout & tokenizer configuration match
+ *			and all tokens & index slots are in range, else the source is
+ *			parsed and the cache (re)written via a temporary file, failure to write is not an error.
+ *			Source & tokens are mapped copy-on-write, xJsonStringView() changes are never written back.
+ */
+int xJsonFileLoad(json_file_t * psF, const char * pcPath, int fIndex);
+
+/**
+ * @brief	Release parse handler and unmap source & cache
+ */
+void vJsonFileUnload(json_file_t * psF);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
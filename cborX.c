@@ -0,0 +1,311 @@
+/*
+ * cborX.c - Copyright 2014-25 Andre M. Maree / KSS Technologies (Pty) Ltd.
+ *
+ * Compact binary alternative to the JSON text, selected per writer context.
+ *
+ * References:
+ *	RFC 8949 Concise Binary Object Representation (CBOR)
+ */
+
+#include "hal_platform.h"
+#include "cborX.h"
+#include "syslog.h"
+
+#include <string.h>
+#include <math.h>
+
+// ############################### BUILD: debug configuration options ##############################
+
+#define	debugFLAG					0xF000
+#define	debugTIMING					(debugFLAG_GLOBAL & debugFLAG & 0x1000)
+#define	debugTRACK					(debugFLAG_GLOBAL & debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG_GLOBAL & debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG_GLOBAL & debugFLAG & 0x8000)
+
+// ############################################ structures #########################################
+
+typedef struct cbor_item_t {
+	u64_t Val;											// argument, length or count
+	f64_t F64;											// float value (major 7, info 25..27)
+	u8_t Major;
+	u8_t Info;											// additional information, 31 = indefinite
+} cbor_item_t;
+
+// ####################################### Local Functions #########################################
+
+static void vCborPutBE(u8_t * pu8Buf, u64_t Val, int Len) {
+	while (Len--) {
+		pu8Buf[Len] = Val & 0xFF;
+		Val >>= 8;
+	}
+}
+
+static u64_t xCborGetBE(const u8_t * pu8Buf, int Len) {
+	u64_t Val = 0;
+	for (int i = 0; i < Len; ++i)
+		Val = (Val << 8) | pu8Buf[i];
+	return Val;
+}
+
+static f64_t dCborHalf(u16_t Half) {
+	int Exp = (Half >> 10) & 0x1F;
+	int Mant = Half & 0x3FF;
+	f64_t Val = (Exp == 0) ? ldexp(Mant, -24) : (Exp != 31) ? ldexp(Mant + 1024, Exp - 25) : (Mant == 0) ? INFINITY : NAN;
+	return (Half & 0x8000) ? -Val : Val;
+}
+
+/**
+ * @brief	decode an item head, including the argument and float value
+ * @return	pointer to the item content or NULL if truncated/invalid
+ */
+static const u8_t * pu8CborHead(const u8_t * pu8Buf, const u8_t * pu8End, cbor_item_t * psI) {
+	if (pu8Buf >= pu8End)
+		return NULL;
+	psI->Major = *pu8Buf >> 5;
+	psI->Info = *pu8Buf++ & 0x1F;
+	psI->Val = psI->Info;
+	if (psI->Info >= 24 && psI->Info <= 27) {
+		int Len = 1 << (psI->Info - 24);
+		if ((pu8End - pu8Buf) < Len)
+			return NULL;
+		psI->Val = xCborGetBE(pu8Buf, Len);
+		pu8Buf += Len;
+		if (psI->Major == cborMAJOR_SIMPLE) {
+			if (psI->Info == 25) {
+				psI->F64 = dCborHalf(psI->Val);
+			} else if (psI->Info == 26) {
+				u32_t U32 = psI->Val;
+				f32_t F32;
+				memcpy(&F32, &U32, sizeof(F32));
+				psI->F64 = F32;
+			} else if (psI->Info == 27) {
+				memcpy(&psI->F64, &psI->Val, sizeof(f64_t));
+			}
+		}
+	} else if (psI->Info >= 28 && psI->Info <= 30) {
+		return NULL;									// reserved
+	} else if (psI->Info == 31 && (psI->Major < cborMAJOR_BSTR || psI->Major == cborMAJOR_TAG)) {
+		return NULL;									// no indefinite form
+	}
+	return pu8Buf;
+}
+
+/**
+ * @brief	skip a complete item, nested items included, without recursion
+ * @return	pointer to following item or NULL if truncated/invalid/too deep
+ */
+static const u8_t * pu8CborSkip(const u8_t * pu8Buf, const u8_t * pu8End) {
+	i64_t Pending[cborMAX_DEPTH];						// items left per level, -1 = until break
+	int Depth = 0;
+	Pending[0] = 1;
+	while (Depth >= 0) {
+		if (Pending[Depth] == 0) {
+			--Depth;
+			continue;
+		}
+		if (Pending[Depth] < 0 && pu8Buf < pu8End && *pu8Buf == cborBREAK) {
+			++pu8Buf;
+			--Depth;
+			continue;
+		}
+		cbor_item_t sI;
+		pu8Buf = pu8CborHead(pu8Buf, pu8End, &sI);
+		if (pu8Buf == NULL)
+			return NULL;
+		if (Pending[Depth] > 0)
+			--Pending[Depth];
+		i64_t Count = 0;
+		switch (sI.Major) {
+		case cborMAJOR_BSTR:
+		case cborMAJOR_TSTR:
+			if (sI.Info == 31) {
+				Count = -1;								// chunks follow until break
+			} else if (sI.Val > (u64_t) (pu8End - pu8Buf)) {
+				return NULL;
+			} else {
+				pu8Buf += sI.Val;
+			}
+			break;
+		case cborMAJOR_ARRAY: Count = (sI.Info == 31) ? -1 : (i64_t) sI.Val; break;
+		case cborMAJOR_MAP: Count = (sI.Info == 31) ? -1 : (i64_t) sI.Val * 2; break;
+		case cborMAJOR_TAG: Count = 1; break;			// tagged item follows
+		case cborMAJOR_SIMPLE:
+			if (sI.Info == 31)
+				return NULL;							// unexpected break
+			break;
+		default: break;									// integers, head only
+		}
+		if (Count) {
+			if (++Depth == cborMAX_DEPTH)
+				return NULL;
+			Pending[Depth] = Count;
+		}
+	}
+	return pu8Buf;
+}
+
+/**
+ * @brief	store an integer, magnitude & sign, range checked for the type
+ * @return	1 if stored else 0
+ */
+static int xCborStoreInt(px_t pX, cvi_e cvI, u64_t Mag, int fNeg) {
+	if (fNeg && Mag == 0)
+		fNeg = 0;
+	i64_t I64 = fNeg ? (i64_t) (0 - Mag) : (i64_t) Mag;
+	switch (cvI) {
+	case cvU08: if (fNeg || Mag > UINT8_MAX) return 0; *pX.pu8 = Mag; break;
+	case cvU16: if (fNeg || Mag > UINT16_MAX) return 0; *pX.pu16 = Mag; break;
+	case cvU32: if (fNeg || Mag > UINT32_MAX) return 0; *pX.pu32 = Mag; break;
+	case cvU64: if (fNeg) return 0; *pX.pu64 = Mag; break;
+	case cvI08: if (Mag > (fNeg ? 128ULL : 127ULL)) return 0; *pX.pi8 = I64; break;
+	case cvI16: if (Mag > (fNeg ? 32768ULL : 32767ULL)) return 0; *pX.pi16 = I64; break;
+	case cvI32: if (Mag > (fNeg ? 2147483648ULL : 2147483647ULL)) return 0; *pX.pi32 = I64; break;
+	case cvI64: if (Mag > (fNeg ? (1ULL << 63) : (u64_t) INT64_MAX)) return 0; *pX.pi64 = I64; break;
+	case cvF32: *pX.pf32 = fNeg ? -(f32_t) Mag : (f32_t) Mag; break;
+	case cvF64: *pX.pf64 = fNeg ? -(f64_t) Mag : (f64_t) Mag; break;
+	default: return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief	decode a value item into an entry
+ * @return	1 if stored else 0
+ */
+static int xCborParseValue(const u8_t * pu8Buf, const u8_t * pu8End, ph_entry_t * psEntry) {
+	cbor_item_t sI;
+	pu8Buf = pu8CborHead(pu8Buf, pu8End, &sI);
+	if (pu8Buf == NULL)
+		return 0;
+	if (psEntry->pxVar.pv == NULL)
+		return 1;
+	cvi_e cvI = psEntry->cvI;
+	switch (sI.Major) {
+	case cborMAJOR_UINT: return xCborStoreInt(psEntry->pxVar, cvI, sI.Val, 0);
+	case cborMAJOR_NINT:
+		if (sI.Val == UINT64_MAX)
+			return 0;
+		return xCborStoreInt(psEntry->pxVar, cvI, sI.Val + 1, 1);
+	case cborMAJOR_TSTR:
+		if (cvI != cvSXX || sI.Info == 31 || sI.Val > (u64_t) (pu8End - pu8Buf))
+			return 0;
+		if (psEntry->szVar && sI.Val >= psEntry->szVar) {
+			sI.Val = psEntry->szVar - 1;				// truncate on a UTF-8 character boundary
+			while (sI.Val && (pu8Buf[sI.Val] & 0xC0) == 0x80)
+				--sI.Val;
+		}
+		memcpy(psEntry->pxVar.pc8, pu8Buf, sI.Val);
+		psEntry->pxVar.pc8[sI.Val] = CHR_NUL;
+		return 1;
+	case cborMAJOR_SIMPLE:
+		if (sI.Info == 20 || sI.Info == 21)				// false/true as 0/1
+			return xCborStoreInt(psEntry->pxVar, cvI, sI.Info - 20, 0);
+		if (sI.Info < 25 || sI.Info > 27)
+			return 0;
+		if (cvI == cvF32) {
+			*psEntry->pxVar.pf32 = sI.F64;
+			return 1;
+		}
+		if (cvI == cvF64) {
+			*psEntry->pxVar.pf64 = sI.F64;
+			return 1;
+		}
+		if (sI.F64 != floor(sI.F64) || fabs(sI.F64) >= 18446744073709551616.0)
+			return 0;									// integer targets only accept integral values
+		return xCborStoreInt(psEntry->pxVar, cvI, (u64_t) fabs(sI.F64), sI.F64 < 0);
+	default: return 0;
+	}
+}
+
+// ####################################### Global Functions ########################################
+
+int xCborFormatHead(u8_t * pu8Buf, int Major, u64_t Val) {
+	u8_t Ib = Major << 5;
+	if (Val < 24) {
+		pu8Buf[0] = Ib | Val;
+		return 1;
+	}
+	int Info = (Val <= UINT8_MAX) ? 24 : (Val <= UINT16_MAX) ? 25 : (Val <= UINT32_MAX) ? 26 : 27;
+	int Len = 1 << (Info - 24);
+	pu8Buf[0] = Ib | Info;
+	vCborPutBE(pu8Buf + 1, Val, Len);
+	return Len + 1;
+}
+
+int xCborFormatU64(u8_t * pu8Buf, u64_t U64) { return xCborFormatHead(pu8Buf, cborMAJOR_UINT, U64); }
+
+int xCborFormatI64(u8_t * pu8Buf, i64_t I64) {
+	if (I64 >= 0)
+		return xCborFormatHead(pu8Buf, cborMAJOR_UINT, I64);
+	return xCborFormatHead(pu8Buf, cborMAJOR_NINT, (u64_t) -(I64 + 1));
+}
+
+int xCborFormatF32(u8_t * pu8Buf, f32_t F32) {
+	u32_t U32;
+	memcpy(&U32, &F32, sizeof(U32));
+	pu8Buf[0] = cborFLOAT32;
+	vCborPutBE(pu8Buf + 1, U32, sizeof(U32));
+	return 1 + sizeof(U32);
+}
+
+int xCborFormatF64(u8_t * pu8Buf, f64_t F64) {
+	u64_t U64;
+	memcpy(&U64, &F64, sizeof(U64));
+	pu8Buf[0] = cborFLOAT64;
+	vCborPutBE(pu8Buf + 1, U64, sizeof(U64));
+	return 1 + sizeof(U64);
+}
+
+/**
+ * @brief	decode the members of the top level map into up to jsonENTRIES_WALK entries
+ * @return	bitmap of entries found and parsed successfully
+ */
+static u64_t xCborParseWalk(const u8_t * pu8Buf, const u8_t * pu8End, ph_entry_t * psEntry, int Count) {
+	cbor_item_t sI;
+	pu8Buf = pu8CborHead(pu8Buf, pu8End, &sI);
+	if (pu8Buf == NULL || sI.Major != cborMAJOR_MAP)
+		return 0;
+	size_t szKey[jsonENTRIES_WALK];						// once per walk, not per member & entry
+	for (int e = 0; e < Count; ++e)
+		szKey[e] = strlen(psEntry[e].pcKey);
+	u64_t All = (Count < 64) ? (1ULL << Count) - 1 : ~0ULL;
+	u64_t Done = 0, Found = 0;							// entries already decoded, first occurrence wins
+	for (u64_t Num = sI.Val; ((sI.Info == 31) || Num) && (Done != All); --Num) {
+		if (sI.Info == 31 && pu8Buf < pu8End && *pu8Buf == cborBREAK)
+			break;
+		cbor_item_t sK;
+		const u8_t * pu8Key = pu8CborHead(pu8Buf, pu8End, &sK);
+		if (pu8Key == NULL)
+			break;
+		const u8_t * pu8Val;
+		if (sK.Major == cborMAJOR_TSTR && sK.Info != 31 && sK.Val <= (u64_t) (pu8End - pu8Key)) {
+			pu8Val = pu8Key + sK.Val;
+			for (u64_t Left = All & ~Done; Left; Left &= Left - 1) {	// entries not yet decoded only
+				int e = __builtin_ctzll(Left);
+				if (szKey[e] != sK.Val || memcmp(psEntry[e].pcKey, pu8Key, sK.Val) != 0)
+					continue;
+				Done |= 1ULL << e;
+				if (xCborParseValue(pu8Val, pu8End, &psEntry[e]))
+					Found |= 1ULL << e;
+				// duplicate keys in table all decoded from the same value, continue matching
+			}
+		} else {
+			pu8Val = pu8CborSkip(pu8Buf, pu8End);		// not a text key, skip it
+		}
+		pu8Buf = pu8Val ? pu8CborSkip(pu8Val, pu8End) : NULL;
+		if (pu8Buf == NULL)
+			break;
+	}
+	return Found;
+}
+
+u64_t xCborParseEntries(const u8_t * pu8Buf, size_t szBuf, ph_entries_t * psEntries) {
+	u64_t Found = 0;
+	for (int e = 0; e < psEntries->Count; e += jsonENTRIES_WALK) {	// bounded state, 1 walk per 64 entries
+		int Num = (psEntries->Count - e < jsonENTRIES_WALK) ? psEntries->Count - e : jsonENTRIES_WALK;
+		u64_t Walk = xCborParseWalk(pu8Buf, pu8Buf + szBuf, &psEntries->Entry[e], Num);
+		if (e == 0)
+			Found = Walk;								// only the first 64 reported
+	}
+	return Found;
+}
@@ -0,0 +1,67 @@
+// cborX.h - CBOR (RFC 8949) encoding helpers for the writer & ph_entries_t table decoder
+
+#pragma once
+
+#include "complex_vars.h"
+#include "parserX.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ########################################## macros ###############################################
+
+#define	cborMAJOR_UINT				0
+#define	cborMAJOR_NINT				1
+#define	cborMAJOR_BSTR				2
+#define	cborMAJOR_TSTR				3
+#define	cborMAJOR_ARRAY				4
+#define	cborMAJOR_MAP				5
+#define	cborMAJOR_TAG				6
+#define	cborMAJOR_SIMPLE			7
+
+#define	cborARRAY_INDEF				0x9F
+#define	cborMAP_INDEF				0xBF
+#define	cborFALSE					0xF4
+#define	cborTRUE					0xF5
+#define	cborNULL					0xF6
+#define	cborFLOAT16					0xF9
+#define	cborFLOAT32					0xFA
+#define	cborFLOAT64					0xFB
+#define	cborBREAK					0xFF
+
+#define	cborHEAD_SIZE				9					// largest head, initial byte + 8 byte argument
+#define	cborMAX_DEPTH				32					// nesting levels of indefinite/definite items skipped
+
+// ####################################### global functions ########################################
+
+/**
+ * @brief	encode an item head, shortest form of the argument
+ * @param	pu8Buf - output, at least cborHEAD_SIZE bytes
+ * @return	number of bytes written
+ */
+int xCborFormatHead(u8_t * pu8Buf, int Major, u64_t Val);
+
+/**
+ * @brief	encode integers (major type 0 or 1) and floats (float32/float64, never narrowed)
+ * @param	pu8Buf - output, at least cborHEAD_SIZE bytes
+ * @return	number of bytes written
+ */
+int xCborFormatU64(u8_t * pu8Buf, u64_t U64);
+int xCborFormatI64(u8_t * pu8Buf, i64_t I64);
+int xCborFormatF32(u8_t * pu8Buf, f32_t F32);
+int xCborFormatF64(u8_t * pu8Buf, f64_t F64);
+
+/**
+ * @brief	Decode the members of the top level map into a table of entries
+ * @return	bitmap of entries found and parsed successfully, bit N = Entry[N]
+ * @note	Numbers are range checked against cvI (cvU08 -> cvF64), text strings copied for cvSXX
+ * @note	Nested maps/arrays, tags and byte strings are skipped, keys MUST be definite text strings
+ * @note	First occurrence of a key in the map wins, entries with the same key share its value.
+ *			All entries are parsed but only the first 64 can be reported
+ */
+u64_t xCborParseEntries(const u8_t * pu8Buf, size_t szBuf, ph_entries_t * psEntries);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,842 @@
+/*
+ * bench.c - jsonX host benchmark
+ *
+ *	jsonx_bench [-q] [filter]
+ *		-q		quick run, few iterations per case (used by ctest as a smoke test)
+ *		filter	only run cases whose name contains this string
+ *
+ * Every case validates its result on the first call, a failing case is reported and
+ * sets the exit status. Throughput is source (or output) bytes per second, 1MB = 1e6 bytes.
+ */
+
+#include "parserX.h"
+#include "writerX.h"
+#include "batchX.h"
+#include "cacheX.h"
+#include "cborX.h"
+#include "saxX.h"
+#include "schemaX.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// ########################################### macros ##############################################
+
+#define	benchMIN_NS_FULL		500000000ULL			// run each case for at least 0.5s
+#define	benchMIN_NS_QUICK		2000000ULL				// 2ms in quick mode
+#if (jsonTOKEN_COMPACT == 1)
+	#define	benchLARGE_RECORDS	200						// ~50KB, compact tokens limited to jsonTOK_MAX_LEN
+#else
+	#define	benchLARGE_RECORDS	2500					// records in the large document, ~600KB
+#endif
+#define	benchFLAT_KEYS			256						// keys in the flat document
+#define	benchCOLUMN_RECORDS		256						// records in the row/column cases
+#define	benchMAX_THREADS		16
+#define	benchNDJSON_RECORDS		4096					// records in the NDJSON document, ~1MB
+#define	benchTHREAD_DOCS		64						// documents encoded per thread per call
+
+// ######################################## structures #############################################
+
+typedef struct bench_t {
+	const char * pcName;
+	size_t (* hdlr)(void);								// 1 call, returns bytes processed, 0 if failed
+} bench_t;
+
+typedef struct bench_doc_t {
+	char * pcBuf;
+	size_t szBuf;
+} bench_doc_t;
+
+// ######################################## local variables ########################################
+
+static bench_doc_t sSmall, sRecord, sLarge, sFlat, sResp, sNDJ;
+static parse_hdlr_t sPH;
+static char caOut[1 << 21];
+static volatile size_t szSink;							// defeats dead code elimination
+static char caDir[64], caSrc[96], caCache[104];			// cache cases, temporary directory
+
+// ####################################### corpus generation #######################################
+
+static void vBenchAppend(bench_doc_t * psD, size_t * pszMax, const char * pcFormat, ...) __attribute__((format(printf, 3, 4)));
+
+static void vBenchAppend(bench_doc_t * psD, size_t * pszMax, const char * pcFormat, ...) {
+	va_list vaList;
+	for (;;) {
+		va_start(vaList, pcFormat);
+		int iRV = vsnprintf(psD->pcBuf + psD->szBuf, *pszMax - psD->szBuf, pcFormat, vaList);
+		va_end(vaList);
+		if ((size_t) iRV < *pszMax - psD->szBuf) {
+			psD->szBuf += iRV;
+			return;
+		}
+		*pszMax *= 2;
+		psD->pcBuf = realloc(psD->pcBuf, *pszMax);
+		assert(psD->pcBuf != NULL);
+	}
+}
+
+static void vBenchRecord(bench_doc_t * psD, size_t * pszMax, int Rec) {
+	vBenchAppend(psD, pszMax, "{\"id\":%d,\"name\":\"sensor-%04d\",\"enabled\":%s,\"gain\":%d.%03d,"
+		"\"offset\":-%d.5e-3,\"unit\":\"\\u00b0C\",\"tags\":[\"indoor\",\"zone %d\",\"line\\tfeed\"],"
+		"\"limits\":{\"lo\":%d,\"hi\":%d,\"hyst\":0.25},\"history\":[",
+		Rec, Rec, (Rec & 1) ? "true" : "false", Rec % 10, Rec % 1000, Rec % 97, Rec % 8, -(Rec % 40), 40 + Rec % 60);
+	for (int i = 0; i < 8; ++i)
+		vBenchAppend(psD, pszMax, "%s%d.%d", i ? "," : "", (Rec * 31 + i * 7) % 500, i);
+	vBenchAppend(psD, pszMax, "],\"note\":null}");
+}
+
+static void vBenchCorpus(void) {
+	size_t szMax = 256;
+	sSmall.pcBuf = malloc(szMax);
+	vBenchAppend(&sSmall, &szMax, "{\"cmd\":\"set\",\"id\":1234,\"ts\":1718000000,\"value\":23.5,\"ok\":true,\"tags\":[\"a\",\"b\"]}");
+
+	szMax = 512;
+	sRecord.pcBuf = malloc(szMax);
+	vBenchAppend(&sRecord, &szMax, "{\"device\":\"node-17\",\"sensors\":[");
+	for (int i = 0; i < 12; ++i) {
+		vBenchAppend(&sRecord, &szMax, i ? "," : "");
+		vBenchRecord(&sRecord, &szMax, i);
+	}
+	vBenchAppend(&sRecord, &szMax, "]}");
+
+	szMax = 1 << 16;
+	sLarge.pcBuf = malloc(szMax);
+	vBenchAppend(&sLarge, &szMax, "{\"version\":3,\"site\":\"plant \\\"north\\\"\",\"records\":[");
+	for (int i = 0; i < benchLARGE_RECORDS; ++i) {
+		vBenchAppend(&sLarge, &szMax, i ? ",\n" : "\n");
+		vBenchRecord(&sLarge, &szMax, i);
+	}
+	vBenchAppend(&sLarge, &szMax, "\n]}");
+	#if (jsonTOKEN_COMPACT == 1)
+	assert(sLarge.szBuf <= jsonTOK_MAX_LEN);
+	#endif
+
+	szMax = 4096;
+	sResp.pcBuf = malloc(szMax);						// HTTP style response, header values then data
+	vBenchAppend(&sResp, &szMax, "{\"status\":\"ok\",\"code\":200,\"device\":\"node-17\",\"fw\":\"1.2.3\","
+		"\"uptime\":123456,\"temp\":21.5,\"hum\":45,\"press\":1013.25,\"data\":[");
+	for (int i = 0; i < 8; ++i) {
+		vBenchAppend(&sResp, &szMax, i ? "," : "");
+		vBenchRecord(&sResp, &szMax, i);
+	}
+	vBenchAppend(&sResp, &szMax, "],\"rssi\":-67,\"ts\":1718000000,\"lat\":-33.925,\"lon\":18.424,\"alt\":12,"
+		"\"site\":\"north gate\",\"mode\":3,\"level\":7}");
+
+	szMax = 1 << 16;
+	sNDJ.pcBuf = malloc(szMax);							// 1 record per line
+	for (int i = 0; i < benchNDJSON_RECORDS; ++i) {
+		vBenchRecord(&sNDJ, &szMax, i);
+		vBenchAppend(&sNDJ, &szMax, "\n");
+	}
+
+	szMax = 4096;
+	sFlat.pcBuf = malloc(szMax);
+	vBenchAppend(&sFlat, &szMax, "{");
+	for (int i = 0; i < benchFLAT_KEYS; ++i)
+		vBenchAppend(&sFlat, &szMax, "%s\"key%03d\":%d", i ? "," : "", i, i * 3);
+	vBenchAppend(&sFlat, &szMax, "}");
+}
+
+// ########################################## parser cases #########################################
+
+/**
+ * @brief	run a case with stderr silenced, for cases that log expected errors on every call
+ */
+static size_t szBenchQuiet(size_t (* hdlr)(int), int Arg) {
+	fflush(stderr);
+	int fdErr = dup(STDERR_FILENO), fdNull = open("/dev/null", O_WRONLY);
+	dup2(fdNull, STDERR_FILENO);
+	size_t szRV = hdlr(Arg);
+	dup2(fdErr, STDERR_FILENO);
+	close(fdNull);
+	close(fdErr);
+	return szRV;
+}
+
+static size_t szBenchParse(bench_doc_t * psD) {
+	vJsonParseReset(&sPH);
+	sPH.pcBuf = psD->pcBuf;
+	sPH.szBuf = psD->szBuf;
+	return (xJsonParse(&sPH) > 0) ? psD->szBuf : 0;
+}
+
+static size_t szBenchParseSmall(void) { return szBenchParse(&sSmall); }
+static size_t szBenchParseRecord(void) { return szBenchParse(&sRecord); }
+static size_t szBenchParseLarge(void) { return szBenchParse(&sLarge); }
+
+/**
+ * @brief	previous xJsonParse(), count pass then fill pass into a token array allocated per call
+ */
+static size_t szBenchTwoPass(bench_doc_t * psD) {
+	jsmn_parser sParser;
+	jsmn_init(&sParser);
+	int NumTok = jsmn_parse(&sParser, psD->pcBuf, psD->szBuf, NULL, 0);
+	if (NumTok <= 0)
+		return 0;
+	jsmntok_t * psT0 = calloc(NumTok + jsonEXTRA_SIZE, sizeof(jsmntok_t));
+	if (psT0 == NULL)
+		return 0;
+	jsmn_init(&sParser);
+	int iRV = jsmn_parse(&sParser, psD->pcBuf, psD->szBuf, psT0, NumTok);
+	free(psT0);
+	return (iRV == NumTok) ? psD->szBuf : 0;
+}
+
+static size_t szBenchTwoPassSmall(void) { return szBenchTwoPass(&sSmall); }
+static size_t szBenchTwoPassRecord(void) { return szBenchTwoPass(&sRecord); }
+static size_t szBenchTwoPassLarge(void) { return szBenchTwoPass(&sLarge); }
+
+static size_t szBenchValidate(bench_doc_t * psD) {
+	return (xJsonValidate(psD->pcBuf, psD->szBuf, NULL) == erSUCCESS) ? psD->szBuf : 0;
+}
+
+static size_t szBenchValidateSmall(void) { return szBenchValidate(&sSmall); }
+static size_t szBenchValidateRecord(void) { return szBenchValidate(&sRecord); }
+static size_t szBenchValidateLarge(void) { return szBenchValidate(&sLarge); }
+
+/**
+ * @brief	truncated response, rejected by the validator vs by a full parse
+ */
+static size_t szBenchReject(int fParse) {
+	size_t szBuf = sLarge.szBuf - 3, szErr;
+	if (fParse) {
+		vJsonParseReset(&sPH);
+		sPH.pcBuf = sLarge.pcBuf;
+		sPH.szBuf = szBuf;
+		return (xJsonParse(&sPH) == JSMN_ERROR_PART) ? szBuf : 0;
+	}
+	return (xJsonValidate(sLarge.pcBuf, szBuf, &szErr) == JSMN_ERROR_PART) ? szBuf : 0;
+}
+
+static size_t szBenchRejectParse(void) { return szBenchQuiet(szBenchReject, 1); }
+static size_t szBenchRejectValidate(void) { return szBenchReject(0); }
+
+static size_t szBenchFind(int fIndex) {
+	static char caKey[8];
+	static int Key;
+	if (sPH.pcBuf != sFlat.pcBuf) {
+		vJsonParseRelease(&sPH);
+		sPH.pcBuf = sFlat.pcBuf;
+		sPH.szBuf = sFlat.szBuf;
+		if (xJsonParse(&sPH) <= 0)
+			return 0;
+	}
+	if (fIndex && sPH.MaskIdx == 0 && xJsonIndexBuild(&sPH) <= 0)
+		return 0;
+	if (fIndex == 0)
+		sPH.MaskIdx = 0;
+	Key = (Key + 97) % benchFLAT_KEYS;					// spread lookups over the document
+	snprintf(caKey, sizeof(caKey), "key%03d", Key);
+	int Tok = xJsonFindToken(&sPH, caKey, 1);
+	if (Tok < 0 || atoi(sPH.pcBuf + sPH.psT0[Tok].start) != Key * 3)
+		return 0;
+	return strlen(caKey);
+}
+
+static size_t szBenchFindLinear(void) { return szBenchFind(0); }
+static size_t szBenchFindIndex(void) { return szBenchFind(1); }
+
+static size_t szBenchEmit(int Indent) {
+	if (sPH.pcBuf != sLarge.pcBuf && szBenchParseLarge() == 0)
+		return 0;
+	ubuf_t sUB = { .pBuf = caOut, .Size = sizeof(caOut) };
+	int iRV = xJsonEmit(&sPH, 0, &sUB, Indent);
+	if (iRV <= 0 || (Indent == 0 && (size_t) iRV >= sLarge.szBuf))
+		return 0;
+	return iRV;
+}
+
+static size_t szBenchEmitMinify(void) { return szBenchEmit(0); }
+static size_t szBenchEmitIndent(void) { return szBenchEmit(2); }
+
+// ########################################## writer cases #########################################
+
+/**
+ * @brief	telemetry document, 1 device with 8 sensors, via ecJsonAddKeyValue()
+ */
+static void vBenchTelemetry(json_obj_t * psJ) {
+	static f32_t f32Hist[16];
+	static u32_t u32Id = 1234567, u32Up = 987654;
+	static i16_t i16Rssi = -67;
+	static f32_t f32Temp = 21.53f, f32Gain = 1.125f;
+	static const char * pcaTags[] = { "indoor", "zone 7", "line\tfeed" };
+	json_obj_t sSensors, sS;
+	if (f32Hist[1] == 0) {
+		for (int i = 0; i < 16; ++i)
+			f32Hist[i] = 20.0f + i * 0.37f;
+	}
+	ecJsonAddKeyValue(psJ, "device", (px_t) { .pc8 = "node-17" }, jsonSXX, 0, 0);
+	ecJsonAddKeyValue(psJ, "id", (px_t) { .pu32 = &u32Id }, jsonXXX, cvU32, 0);
+	ecJsonAddKeyValue(psJ, "uptime", (px_t) { .pu32 = &u32Up }, jsonXXX, cvU32, 0);
+	ecJsonAddKeyValue(psJ, "rssi", (px_t) { .pi16 = &i16Rssi }, jsonXXX, cvI16, 0);
+	ecJsonAddKeyValue(psJ, "site", (px_t) { .pc8 = "plant \"north\"" }, jsonSXX, 0, 0);
+	ecJsonAddKeyValue(psJ, "sensors", (px_t) { .pv = &sSensors }, jsonOBJ, 0, 0);
+	for (int i = 0; i < 8; ++i) {
+		static const char * pcaName[] = { "t0", "t1", "t2", "t3", "h0", "h1", "p0", "p1" };
+		ecJsonAddKeyValue(&sSensors, pcaName[i], (px_t) { .pv = &sS }, jsonOBJ, 0, 0);
+		ecJsonAddKeyValue(&sS, "value", (px_t) { .pf32 = &f32Temp }, jsonXXX, cvF32, 0);
+		ecJsonAddKeyValue(&sS, "gain", (px_t) { .pf32 = &f32Gain }, jsonXXX, cvF32, 0);
+		ecJsonAddKeyValue(&sS, "unit", (px_t) { .pc8 = "degC" }, jsonSXX, 0, 0);
+		ecJsonAddKeyValue(&sS, "enabled", (px_t) { 0 }, (i & 1) ? jsonFALSE : jsonTRUE, 0, 0);
+		ecJsonAddKeyValue(&sS, "tags", (px_t) { .ppc8 = (char **) pcaTags }, jsonARRAY, cvSXX, 3);
+		ecJsonAddKeyValue(&sS, "history", (px_t) { .pf32 = f32Hist }, jsonARRAY, cvF32, 16);
+		ecJsonCloseObject(&sS);
+	}
+	ecJsonCloseObject(&sSensors);
+}
+
+static size_t szBenchWriteKV(void) {
+	ubuf_t sUB = { .pBuf = caOut, .Size = sizeof(caOut) };
+	json_obj_t sJ;
+	ecJsonCreateObject(&sJ, &sUB);
+	vBenchTelemetry(&sJ);
+	return (ecJsonCloseObject(&sJ) == erSUCCESS) ? sUB.Used : 0;
+}
+
+static size_t szBenchWritePerChar(void) {				// previous append path, uprintfx("%c") per character
+	static char caDoc[8192];
+	static size_t szDoc;
+	if (szDoc == 0) {
+		szDoc = szBenchWriteKV();
+		if (szDoc == 0 || szDoc > sizeof(caDoc))
+			return 0;
+		memcpy(caDoc, caOut, szDoc);
+	}
+	ubuf_t sUB = { .pBuf = caOut, .Size = sizeof(caOut) };
+	for (size_t i = 0; i < szDoc; ++i)
+		uprintfx(&sUB, "%c", caDoc[i]);
+	return (sUB.Used == szDoc && memcmp(caOut, caDoc, szDoc) == 0) ? szDoc : 0;
+}
+
+// ########################################## entries cases ########################################
+
+static struct { u64_t ts, uptime; f32_t temp, press; f64_t lat, lon; i32_t code, rssi, alt; u8_t hum, mode, level; char status[8], device[16], fw[8], site[16]; } sResv;
+
+static struct { u8_t Count; ph_keys_t * psKeys; ph_entry_t Entry[16]; } sRespEntries = { 16, NULL, {
+	{ "status", { .pc8 = sResv.status }, cvSXX, sizeof(sResv.status) },
+	{ "code", { .pi32 = &sResv.code }, cvI32, 0 },
+	{ "device", { .pc8 = sResv.device }, cvSXX, sizeof(sResv.device) },
+	{ "fw", { .pc8 = sResv.fw }, cvSXX, sizeof(sResv.fw) },
+	{ "uptime", { .pu64 = &sResv.uptime }, cvU64, 0 },
+	{ "temp", { .pf32 = &sResv.temp }, cvF32, 0 },
+	{ "hum", { .pu8 = &sResv.hum }, cvU08, 0 },
+	{ "press", { .pf32 = &sResv.press }, cvF32, 0 },
+	{ "rssi", { .pi32 = &sResv.rssi }, cvI32, 0 },
+	{ "ts", { .pu64 = &sResv.ts }, cvU64, 0 },
+	{ "lat", { .pf64 = &sResv.lat }, cvF64, 0 },
+	{ "lon", { .pf64 = &sResv.lon }, cvF64, 0 },
+	{ "alt", { .pi32 = &sResv.alt }, cvI32, 0 },
+	{ "site", { .pc8 = sResv.site }, cvSXX, sizeof(sResv.site) },
+	{ "mode", { .pu8 = &sResv.mode }, cvU08, 0 },
+	{ "level", { .pu8 = &sResv.level }, cvU08, 0 },
+} };
+
+static int xBenchRespParsed(int fIndex) {
+	if (sPH.pcBuf == sResp.pcBuf)
+		return erSUCCESS;
+	vJsonParseRelease(&sPH);
+	sPH.pcBuf = sResp.pcBuf;
+	sPH.szBuf = sResp.szBuf;
+	sPH.fIndex = fIndex;
+	return (xJsonParse(&sPH) > 0) ? erSUCCESS : erFAILURE;
+}
+
+static size_t szBenchRespCheck(u64_t Found) {			// all found & values right, then cleared for the next call
+	if (Found != 0xFFFF || sResv.code != 200 || sResv.rssi != -67 || sResv.level != 7 || strcmp(sResv.site, "north gate"))
+		return 0;
+	memset(&sResv, 0, sizeof(sResv));
+	return sResp.szBuf;
+}
+
+static size_t szBenchEntriesLoop(void) {				// 1 xJsonParseEntry() per key, each rescans the tokens
+	if (xBenchRespParsed(0) != erSUCCESS)
+		return 0;
+	u64_t Found = 0;
+	for (int e = 0; e < sRespEntries.Count; ++e) {
+		if (xJsonParseEntry(&sPH, &sRespEntries.Entry[e]))
+			Found |= 1ULL << e;
+	}
+	return szBenchRespCheck(Found);
+}
+
+static size_t szBenchEntriesTable(void) {
+	if (xBenchRespParsed(0) != erSUCCESS)
+		return 0;
+	return szBenchRespCheck(xJsonParseEntries(&sPH, (ph_entries_t *) &sRespEntries));
+}
+
+static size_t szBenchEntriesIndex(void) {
+	if (xBenchRespParsed(1) != erSUCCESS || sPH.MaskIdx == 0)
+		return 0;
+	return szBenchRespCheck(xJsonParseEntries(&sPH, (ph_entries_t *) &sRespEntries));
+}
+
+// ########################################### schema cases ########################################
+
+typedef struct bench_resp_t {
+	char status[8];
+	i32_t code;
+	char device[16], fw[8];
+	u64_t uptime;
+	f32_t temp;
+	u8_t hum;
+	f32_t press;
+	i32_t rssi;
+	u64_t ts;
+	f64_t lat, lon;
+	i32_t alt;
+	char site[16];
+	u8_t mode, level;
+} bench_resp_t;
+
+#define	benchRESP_FIELDS(X, T)													\
+	X(T, status, STR) X(T, code, I32) X(T, device, STR) X(T, fw, STR)			\
+	X(T, uptime, U64) X(T, temp, F32) X(T, hum, U08) X(T, press, F32)			\
+	X(T, rssi, I32) X(T, ts, U64) X(T, lat, F64) X(T, lon, F64)				\
+	X(T, alt, I32) X(T, site, STR) X(T, mode, U08) X(T, level, U08)
+
+jsonSCHEMA_DEFINE(benchResp, bench_resp_t, benchRESP_FIELDS)
+
+static bench_resp_t sRespV = { "ok", 200, "node-17", "1.2.3", 123456, 21.5f, 45, 1013.25f,
+	-67, 1718000000, -33.925, 18.424, 12, "north gate", 3, 7 };
+
+static size_t szBenchSchemaOut(size_t szUsed) {			// 1st call keeps the output, later calls must match
+	static char caRef[1024];
+	static size_t szRef;
+	if (szRef == 0 && szUsed <= sizeof(caRef)) {
+		memcpy(caRef, caOut, szUsed);
+		szRef = szUsed;
+	}
+	return (szUsed == szRef && memcmp(caOut, caRef, szRef) == 0) ? szUsed : 0;
+}
+
+/**
+ * @brief	response members, hand written, 1 ecJsonAddKeyValue() per member
+ */
+static void vBenchRespKV(json_obj_t * psJ) {
+	bench_resp_t * psV = &sRespV;
+	ecJsonAddKeyValue(psJ, "status", (px_t) { .pc8 = psV->status }, jsonSXX, 0, 0);
+	ecJsonAddKeyValue(psJ, "code", (px_t) { .pi32 = &psV->code }, jsonXXX, cvI32, 0);
+	ecJsonAddKeyValue(psJ, "device", (px_t) { .pc8 = psV->device }, jsonSXX, 0, 0);
+	ecJsonAddKeyValue(psJ, "fw", (px_t) { .pc8 = psV->fw }, jsonSXX, 0, 0);
+	ecJsonAddKeyValue(psJ, "uptime", (px_t) { .pu64 = &psV->uptime }, jsonXXX, cvU64, 0);
+	ecJsonAddKeyValue(psJ, "temp", (px_t) { .pf32 = &psV->temp }, jsonXXX, cvF32, 0);
+	ecJsonAddKeyValue(psJ, "hum", (px_t) { .pu8 = &psV->hum }, jsonXXX, cvU08, 0);
+	ecJsonAddKeyValue(psJ, "press", (px_t) { .pf32 = &psV->press }, jsonXXX, cvF32, 0);
+	ecJsonAddKeyValue(psJ, "rssi", (px_t) { .pi32 = &psV->rssi }, jsonXXX, cvI32, 0);
+	ecJsonAddKeyValue(psJ, "ts", (px_t) { .pu64 = &psV->ts }, jsonXXX, cvU64, 0);
+	ecJsonAddKeyValue(psJ, "lat", (px_t) { .pf64 = &psV->lat }, jsonXXX, cvF64, 0);
+	ecJsonAddKeyValue(psJ, "lon", (px_t) { .pf64 = &psV->lon }, jsonXXX, cvF64, 0);
+	ecJsonAddKeyValue(psJ, "alt", (px_t) { .pi32 = &psV->alt }, jsonXXX, cvI32, 0);
+	ecJsonAddKeyValue(psJ, "site", (px_t) { .pc8 = psV->site }, jsonSXX, 0, 0);
+	ecJsonAddKeyValue(psJ, "mode", (px_t) { .pu8 = &psV->mode }, jsonXXX, cvU08, 0);
+	ecJsonAddKeyValue(psJ, "level", (px_t) { .pu8 = &psV->level }, jsonXXX, cvU08, 0);
+}
+
+static size_t szBenchEncodeKV(void) {
+	ubuf_t sUB = { .pBuf = caOut, .Size = sizeof(caOut) };
+	json_obj_t sJ;
+	ecJsonCreateObject(&sJ, &sUB);
+	vBenchRespKV(&sJ);
+	return (ecJsonCloseObject(&sJ) == erSUCCESS) ? szBenchSchemaOut(sUB.Used) : 0;
+}
+
+static size_t szBenchEncodeSchema(void) {
+	ubuf_t sUB = { .pBuf = caOut, .Size = sizeof(caOut) };
+	json_obj_t sJ;
+	ecJsonCreateObject(&sJ, &sUB);
+	benchRespEncode(&sJ, &sRespV);
+	return (ecJsonCloseObject(&sJ) == erSUCCESS) ? szBenchSchemaOut(sUB.Used) : 0;
+}
+
+static size_t szBenchDecodeSchema(void) {				// compare with entries/table, same document & members
+	bench_resp_t sV = { 0 };
+	u64_t Found;
+	if (xBenchRespParsed(0) != erSUCCESS || benchRespDecode(&sPH, 0, &sV, &Found) != 16)
+		return 0;
+	if (Found != 0xFFFF || sV.code != 200 || sV.rssi != -67 || sV.level != 7 || strcmp(sV.site, "north gate"))
+		return 0;
+	return sResp.szBuf;
+}
+
+// ########################################### column cases ########################################
+
+typedef struct bench_rec_t {
+	u64_t ts;
+	f32_t t, h;
+	i32_t rssi;
+	char id[8];
+} bench_rec_t;
+
+static bench_rec_t saRec[benchCOLUMN_RECORDS];
+
+static void vBenchRecords(void) {
+	for (int i = 0; i < benchCOLUMN_RECORDS; ++i) {
+		bench_rec_t * psR = &saRec[i];
+		psR->ts = 1718000000ULL + i * 60;
+		psR->t = 20.0f + (i % 50) * 0.1f;
+		psR->h = 40.0f + (i % 30) * 0.5f;
+		psR->rssi = -60 - (i % 20);
+		snprintf(psR->id, sizeof(psR->id), "n%03d", i % 1000);
+	}
+}
+
+static size_t szBenchRows(void) {						// array of objects, keys repeated per record
+	ubuf_t sUB = { .pBuf = caOut, .Size = sizeof(caOut) };
+	json_obj_t sJ, sArr, sO;
+	ecJsonCreateObject(&sJ, &sUB);
+	ecJsonOpenArray(&sJ, "records", &sArr);
+	for (int i = 0; i < benchCOLUMN_RECORDS; ++i) {
+		bench_rec_t * psR = &saRec[i];
+		ecJsonAddKeyValue(&sArr, NULL, (px_t) { .pv = &sO }, jsonOBJ, 0, 0);
+		ecJsonAddKeyValue(&sO, "ts", (px_t) { .pu64 = &psR->ts }, jsonXXX, cvU64, 0);
+		ecJsonAddKeyValue(&sO, "t", (px_t) { .pf32 = &psR->t }, jsonXXX, cvF32, 0);
+		ecJsonAddKeyValue(&sO, "h", (px_t) { .pf32 = &psR->h }, jsonXXX, cvF32, 0);
+		ecJsonAddKeyValue(&sO, "rssi", (px_t) { .pi32 = &psR->rssi }, jsonXXX, cvI32, 0);
+		ecJsonAddKeyValue(&sO, "id", (px_t) { .pc8 = psR->id }, jsonSXX, 0, 0);
+		ecJsonCloseObject(&sO);
+	}
+	ecJsonCloseArray(&sArr);
+	return (ecJsonCloseObject(&sJ) == erSUCCESS) ? sUB.Used : 0;
+}
+
+static size_t szBenchColumns(void) {					// 1 key : [values] per member
+	ubuf_t sUB = { .pBuf = caOut, .Size = sizeof(caOut) };
+	json_obj_t sJ;
+	size_t Stride = sizeof(bench_rec_t);
+	ecJsonCreateObject(&sJ, &sUB);
+	ecJsonAddKeyColumn(&sJ, "ts", (px_t) { .pu64 = &saRec[0].ts }, cvU64, benchCOLUMN_RECORDS, Stride);
+	ecJsonAddKeyColumn(&sJ, "t", (px_t) { .pf32 = &saRec[0].t }, cvF32, benchCOLUMN_RECORDS, Stride);
+	ecJsonAddKeyColumn(&sJ, "h", (px_t) { .pf32 = &saRec[0].h }, cvF32, benchCOLUMN_RECORDS, Stride);
+	ecJsonAddKeyColumn(&sJ, "rssi", (px_t) { .pi32 = &saRec[0].rssi }, cvI32, benchCOLUMN_RECORDS, Stride);
+	ecJsonAddKeyColumn(&sJ, "id", (px_t) { .pc8 = saRec[0].id }, cvSXX, benchCOLUMN_RECORDS, Stride);
+	return (ecJsonCloseObject(&sJ) == erSUCCESS) ? sUB.Used : 0;
+}
+
+// ########################################### format cases ########################################
+
+static char caJson[512], caCbor[512];					// response members encoded by the encode cases
+static size_t szJson, szCbor;
+
+static size_t szBenchFormat(int Format, void (* hdlrDoc)(json_obj_t *)) {
+	ubuf_t sUB = { .pBuf = caOut, .Size = sizeof(caOut) };
+	json_ctx_t sCtx;
+	json_obj_t sJ;
+	vJsonCtxInit(&sCtx, &sUB, 0);
+	sCtx.Format = Format;
+	ecJsonCreateObjectCtx(&sJ, &sCtx);
+	hdlrDoc(&sJ);
+	return (ecJsonCloseObject(&sJ) == erSUCCESS) ? sUB.Used : 0;
+}
+
+static size_t szBenchKeep(char * pcBuf, size_t szBuf, size_t * pszKeep) {
+	if (szBuf && *pszKeep == 0 && szBuf <= sizeof(caJson)) {
+		memcpy(pcBuf, caOut, szBuf);
+		*pszKeep = szBuf;
+	}
+	return szBuf;
+}
+
+static size_t szBenchEncJson(void) { return szBenchKeep(caJson, szBenchFormat(jsonFMT_JSON, vBenchRespKV), &szJson); }
+static size_t szBenchEncCbor(void) { return szBenchKeep(caCbor, szBenchFormat(jsonFMT_CBOR, vBenchRespKV), &szCbor); }
+static size_t szBenchTelJson(void) { return szBenchFormat(jsonFMT_JSON, vBenchTelemetry); }
+static size_t szBenchTelCbor(void) { return szBenchFormat(jsonFMT_CBOR, vBenchTelemetry); }
+
+static size_t szBenchDecCheck(u64_t Found, size_t szBuf) {
+	return szBenchRespCheck(Found) ? szBuf : 0;
+}
+
+static size_t szBenchDecJson(void) {					// parse & table decode, needs format/json-encode
+	if (szJson == 0 && szBenchEncJson() == 0)
+		return 0;
+	vJsonParseReset(&sPH);
+	sPH.pcBuf = caJson;
+	sPH.szBuf = szJson;
+	if (xJsonParse(&sPH) <= 0)
+		return 0;
+	return szBenchDecCheck(xJsonParseEntries(&sPH, (ph_entries_t *) &sRespEntries), szJson);
+}
+
+static size_t szBenchDecCbor(void) {
+	if (szCbor == 0 && szBenchEncCbor() == 0)
+		return 0;
+	return szBenchDecCheck(xCborParseEntries((u8_t *) caCbor, szCbor, (ph_entries_t *) &sRespEntries), szCbor);
+}
+
+// ########################################## thread cases #########################################
+
+typedef struct bench_thread_t {
+	pthread_t sThread;
+	size_t szDoc;										// size of 1st document, later ones must match
+	char caBuf[8192];
+} bench_thread_t;
+
+static bench_thread_t saThread[benchMAX_THREADS];
+static int NumThreads;									// online CPUs, at least 2, at most benchMAX_THREADS
+
+static void * pvBenchWriter(void * pvArg) {
+	bench_thread_t * psT = pvArg;
+	for (int i = 0; i < benchTHREAD_DOCS; ++i) {
+		ubuf_t sUB = { .pBuf = psT->caBuf, .Size = sizeof(psT->caBuf) };
+		json_ctx_t sCtx;
+		json_obj_t sJ;
+		vJsonCtxInit(&sCtx, &sUB, 0);
+		ecJsonCreateObjectCtx(&sJ, &sCtx);
+		vBenchTelemetry(&sJ);
+		if (ecJsonCloseObject(&sJ) != erSUCCESS || (psT->szDoc && sUB.Used != psT->szDoc))
+			return NULL;
+		psT->szDoc = sUB.Used;
+	}
+	return psT;
+}
+
+/**
+ * @brief	independent documents encoded concurrently, benchTHREAD_DOCS per thread
+ */
+static size_t szBenchThreads(int Num) {
+	size_t szTotal = 0;
+	for (int t = 0; t < Num; ++t) {
+		if (pthread_create(&saThread[t].sThread, NULL, pvBenchWriter, &saThread[t]) != 0)
+			return 0;
+	}
+	for (int t = 0; t < Num; ++t) {
+		void * pvRV;
+		pthread_join(saThread[t].sThread, &pvRV);
+		szTotal = (pvRV && szTotal != SIZE_MAX) ? szTotal + saThread[t].szDoc * benchTHREAD_DOCS : SIZE_MAX;
+	}
+	return (szTotal == SIZE_MAX) ? 0 : szTotal;
+}
+
+static size_t szBenchThreads1(void) { return szBenchThreads(1); }
+static size_t szBenchThreadsN(void) { return szBenchThreads(NumThreads); }
+
+// ########################################### batch cases #########################################
+
+static json_rec_t saNDJ[benchNDJSON_RECORDS];
+static json_batch_t sBatch;								// worker parse handlers retained between calls
+
+static size_t szBenchSplit(void) {
+	return (xJsonBatchSplit(sNDJ.pcBuf, sNDJ.szBuf, saNDJ, benchNDJSON_RECORDS) == benchNDJSON_RECORDS) ? sNDJ.szBuf : 0;
+}
+
+/**
+ * @brief	split & parse all records of the NDJSON document
+ */
+static size_t szBenchBatch(int Threads) {
+	if (szBenchSplit() == 0)
+		return 0;
+	sBatch.psRecs = saNDJ;
+	sBatch.NumRec = benchNDJSON_RECORDS;
+	sBatch.NumThreads = Threads;
+	return (xJsonBatchParse(&sBatch) == benchNDJSON_RECORDS) ? sNDJ.szBuf : 0;
+}
+
+static size_t szBenchBatch1(void) { return szBenchBatch(1); }
+static size_t szBenchBatchN(void) { return szBenchBatch(NumThreads); }
+
+// ########################################### cache cases #########################################
+
+static u64_t xBenchFnv1a64(const void * pvBuf, size_t szBuf) {	// byte serial, previous cache hash
+	const u8_t * pu8 = pvBuf;
+	u64_t Hash = 0xCBF29CE484222325ULL;
+	while (szBuf--)
+		Hash = (Hash ^ *pu8++) * 0x100000001B3ULL;
+	return Hash;
+}
+
+static size_t szBenchHashFnv(void) { szSink += xBenchFnv1a64(sLarge.pcBuf, sLarge.szBuf); return sLarge.szBuf; }
+static size_t szBenchHashXxh(void) { szSink += xJsonHash64(sLarge.pcBuf, sLarge.szBuf); return sLarge.szBuf; }
+
+/**
+ * @brief	load the large document from file, cache state set up by the case
+ * @param	fCached - 1 if the cache must be used, 0 if the source must have been parsed
+ */
+static size_t szBenchFile(int fCached) {
+	if (caDir[0] == 0) {
+		const char * pcTmp = getenv("TMPDIR");
+		snprintf(caDir, sizeof(caDir), "%s/jsonx_bench.XXXXXX", pcTmp ? pcTmp : "/tmp");
+		if (mkdtemp(caDir) == NULL)
+			return 0;
+		snprintf(caSrc, sizeof(caSrc), "%s/large.json", caDir);
+		snprintf(caCache, sizeof(caCache), "%s" jsonCACHE_SUFFIX, caSrc);
+		FILE * psFile = fopen(caSrc, "wb");
+		if (psFile == NULL)
+			return 0;
+		fwrite(sLarge.pcBuf, 1, sLarge.szBuf, psFile);
+		fclose(psFile);
+	}
+	json_file_t sF;
+	int iRV = xJsonFileLoad(&sF, caSrc, 1);
+	int fHit = sF.pvCache != NULL;
+	if (iRV > 0 && xJsonFindToken(&sF.sPH, "version", 1) < 0)
+		iRV = erFAILURE;
+	vJsonFileUnload(&sF);
+	return (iRV > 0 && fHit == fCached) ? sLarge.szBuf : 0;
+}
+
+static size_t szBenchFileParse(void) {					// no cache: map, hash, parse & write cache
+	if (caDir[0])
+		unlink(caCache);
+	return szBenchFile(0);
+}
+
+static size_t szBenchFileHit(void) {
+	if (caDir[0] == 0 && szBenchFile(0) == 0)			// first call creates the cache
+		return 0;
+	return szBenchFile(1);
+}
+
+static size_t szBenchFileStale(void) {					// source changed in place, same size
+	static char cFlip = '3';
+	if (caDir[0] == 0 && szBenchFile(0) == 0)
+		return 0;
+	int fd = open(caSrc, O_WRONLY);
+	cFlip ^= 1;											// "version":3 <-> 2
+	if (fd < 0 || pwrite(fd, &cFlip, 1, 11) != 1) {
+		if (fd >= 0)
+			close(fd);
+		return 0;
+	}
+	close(fd);
+	return szBenchFile(0);
+}
+
+static size_t szBenchFileReadOnly(void) {				// cache location not writable
+	struct stat sStat;
+	if (caDir[0] == 0 && szBenchFile(0) == 0)
+		return 0;
+	if (stat(caCache, &sStat) != 0 || S_ISDIR(sStat.st_mode) == 0) {
+		unlink(caCache);
+		if (mkdir(caCache, 0755) != 0)					// directory in place of the cache file, works as root too
+			return 0;
+	}
+	return szBenchQuiet(szBenchFile, 0);				// expected "not written" warnings
+}
+
+static void vBenchFileCleanup(void) {
+	if (caDir[0] == 0)
+		return;
+	rmdir(caCache);
+	unlink(caCache);
+	unlink(caSrc);
+	rmdir(caDir);
+	caDir[0] = 0;
+}
+
+// ########################################### case table ##########################################
+
+static const bench_t saBench[] = {
+	{ "parse/small",		szBenchParseSmall },
+	{ "parse/record",		szBenchParseRecord },
+	{ "parse/large",		szBenchParseLarge },
+	{ "parse/two-pass-small",	szBenchTwoPassSmall },
+	{ "parse/two-pass-record",	szBenchTwoPassRecord },
+	{ "parse/two-pass-large",	szBenchTwoPassLarge },
+	{ "validate/small",		szBenchValidateSmall },
+	{ "validate/record",	szBenchValidateRecord },
+	{ "validate/large",		szBenchValidateLarge },
+	{ "reject/parse",		szBenchRejectParse },
+	{ "reject/validate",	szBenchRejectValidate },
+	{ "find/linear",		szBenchFindLinear },
+	{ "find/index",			szBenchFindIndex },
+	{ "emit/minify",		szBenchEmitMinify },
+	{ "emit/indent",		szBenchEmitIndent },
+	{ "write/kv",			szBenchWriteKV },
+	{ "write/per-char-uprintfx",	szBenchWritePerChar },
+	{ "entries/loop",		szBenchEntriesLoop },
+	{ "entries/table",		szBenchEntriesTable },
+	{ "entries/table-index",	szBenchEntriesIndex },
+	{ "schema/encode-kv",	szBenchEncodeKV },
+	{ "schema/encode",		szBenchEncodeSchema },
+	{ "schema/decode",		szBenchDecodeSchema },
+	{ "column/rows",		szBenchRows },
+	{ "column/columns",		szBenchColumns },
+	{ "format/json-encode",	szBenchEncJson },
+	{ "format/cbor-encode",	szBenchEncCbor },
+	{ "format/json-decode",	szBenchDecJson },
+	{ "format/cbor-decode",	szBenchDecCbor },
+	{ "format/json-telemetry",	szBenchTelJson },
+	{ "format/cbor-telemetry",	szBenchTelCbor },
+	{ "threads/write-1",	szBenchThreads1 },
+	{ "threads/write-n",	szBenchThreadsN },
+	{ "batch/split",		szBenchSplit },
+	{ "batch/parse-1",		szBenchBatch1 },
+	{ "batch/parse-n",		szBenchBatchN },
+	{ "hash/fnv1a-bytes",	szBenchHashFnv },
+	{ "hash/xxh64",			szBenchHashXxh },
+	{ "file/parse",			szBenchFileParse },
+	{ "file/cache-hit",		szBenchFileHit },
+	{ "file/cache-stale",	szBenchFileStale },
+	{ "file/cache-readonly",	szBenchFileReadOnly },
+};
+
+// ############################################# runner ############################################
+
+static u64_t xBenchClock(void) {
+	struct timespec sTS;
+	clock_gettime(CLOCK_MONOTONIC, &sTS);
+	return (u64_t) sTS.tv_sec * 1000000000ULL + sTS.tv_nsec;
+}
+
+static int xBenchRun(const bench_t * psB, u64_t MinNS) {
+	size_t szCall = psB->hdlr();						// validate & warm up
+	if (szCall == 0) {
+		printf("%-24s FAILED\n", psB->pcName);
+		return erFAILURE;
+	}
+	u64_t Calls = 0, Bytes = 0, T0 = xBenchClock(), T1;
+	size_t Batch = 1;
+	do {
+		for (size_t i = 0; i < Batch; ++i)
+			Bytes += psB->hdlr();
+		Calls += Batch;
+		if (Batch < 1024)
+			Batch *= 2;
+		T1 = xBenchClock();
+	} while ((T1 - T0) < MinNS);
+	double dNS = (double) (T1 - T0);
+	printf("%-24s %10llu calls %12.1f ns/call %10.1f MB/s %10zu B/call\n", psB->pcName,
+		(unsigned long long) Calls, dNS / Calls, Bytes * 1e3 / dNS, szCall);
+	szSink += Bytes;
+	return erSUCCESS;
+}
+
+int main(int argc, char * argv[]) {
+	u64_t MinNS = benchMIN_NS_FULL;
+	const char * pcFilter = NULL;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "-q") == 0)
+			MinNS = benchMIN_NS_QUICK;
+		else
+			pcFilter = argv[i];
+	}
+	vBenchCorpus();
+	vBenchRecords();
+	szBenchWriteKV();									// static telemetry inputs set up before any thread runs
+	long lCPU = sysconf(_SC_NPROCESSORS_ONLN);
+	NumThreads = (lCPU < 2) ? 2 : (lCPU > benchMAX_THREADS) ? benchMAX_THREADS : (int) lCPU;
+	printf("corpus: small %zu, record %zu, large %zu, flat %zu, response %zu, ndjson %zu bytes, %d threads\n",
+		sSmall.szBuf, sRecord.szBuf, sLarge.szBuf, sFlat.szBuf, sResp.szBuf, sNDJ.szBuf, NumThreads);
+	int iRV = erSUCCESS;
+	for (size_t i = 0; i < sizeof(saBench) / sizeof(saBench[0]); ++i) {
+		if (pcFilter && strstr(saBench[i].pcName, pcFilter) == NULL)
+			continue;
+		if (xBenchRun(&saBench[i], MinNS) != erSUCCESS)
+			iRV = erFAILURE;
+		vJsonParseRelease(&sPH);						// each case starts with a clean handler
+		sPH.pcBuf = NULL;
+		vBenchFileCleanup();
+	}
+	free(sSmall.pcBuf);
+	free(sRecord.pcBuf);
+	free(sLarge.pcBuf);
+	free(sFlat.pcBuf);
+	free(sResp.pcBuf);
+	free(sNDJ.pcBuf);
+	vJsonBatchRelease(&sBatch);
+	return (iRV == erSUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,45 @@
+// complex_vars.h - host stand-in: variable pointer union and value type index
+
+#pragma once
+
+#include "hal_platform.h"
+
+typedef union {
+	u64_t u64;
+	i64_t i64;
+	f64_t f64;
+} x64_t;
+
+typedef union {
+	void * pv;
+	char * pc8;
+	char ** ppc8;
+	u8_t * pu8;
+	u16_t * pu16;
+	u32_t * pu32;
+	u64_t * pu64;
+	i8_t * pi8;
+	i16_t * pi16;
+	i32_t * pi32;
+	i64_t * pi64;
+	f32_t * pf32;
+	f64_t * pf64;
+} px_t;
+
+typedef enum {
+	cvU08, cvU16, cvU32, cvU64,
+	cvI08, cvI16, cvI32, cvI64,
+	cvF32, cvF64,
+	cvSXX, cvXXX,
+	cvDT_ELAP, cvDT_UTC, cvDT_ALT, cvDT_TZ,
+} cvi_e;
+
+static inline size_t xIndex2Bytes(cvi_e cvI) {
+	static const u8_t u8Size[] = { 1, 2, 4, 8, 1, 2, 4, 8, 4, 8 };
+	return (cvI <= cvF64) ? u8Size[cvI] : 0;
+}
+
+static inline const char * pcIndex2String(cvi_e cvI) {
+	static const char * const pcName[] = { "U08", "U16", "U32", "U64", "I08", "I16", "I32", "I64", "F32", "F64", "SXX", "XXX" };
+	return (cvI <= cvXXX) ? pcName[cvI] : "DT";
+}
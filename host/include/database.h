@@ -0,0 +1,6 @@
+// database.h - host stand-in, only the dependencies jsonX takes from the database component
+
+#pragma once
+
+#include "complex_vars.h"
+#include "report.h"
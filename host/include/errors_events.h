@@ -0,0 +1,6 @@
+// errors_events.h - host stand-in
+
+#pragma once
+
+#define	erSUCCESS					0
+#define	erFAILURE					-1
@@ -0,0 +1,6 @@
+// hal_memory.h - host stand-in, all memory is addressable
+
+#pragma once
+
+#define	halMemorySRAM(p)			((p) != NULL)
+#define	halMemoryANY(p)				((p) != NULL)
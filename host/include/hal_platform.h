@@ -0,0 +1,49 @@
+// hal_platform.h - host stand-in: base types, character names and debug macros
+
+#pragma once
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t u8_t;
+typedef uint16_t u16_t;
+typedef uint32_t u32_t;
+typedef uint64_t u64_t;
+typedef int8_t i8_t;
+typedef int16_t i16_t;
+typedef int32_t i32_t;
+typedef int64_t i64_t;
+typedef float f32_t;
+typedef double f64_t;
+
+#define	CHR_NUL						'\0'
+#define	CHR_SPACE					' '
+#define	CHR_DOUBLE_QUOTE			'"'
+#define	CHR_COMMA					','
+#define	CHR_COLON					':'
+#define	CHR_BACKSLASH				'\\'
+#define	CHR_L_SQUARE				'['
+#define	CHR_R_SQUARE				']'
+#define	CHR_L_CURLY					'{'
+#define	CHR_R_CURLY					'}'
+
+#define	strNUL						""
+#define	strNL						"\r\n"
+
+#define	INRANGE(l, x, h)			((l) <= (x) && (x) <= (h))
+
+#define	xpfDEFAULT_DECIMALS			3
+#define	xpfMAXIMUM_DECIMALS			15
+
+#ifndef debugFLAG_GLOBAL
+	#define	debugFLAG_GLOBAL		0x0000				// asserts off, as in release builds
+#endif
+
+#define	PX(...)						printf(__VA_ARGS__)
+#define	IF_PX(f, ...)				do { if (f) PX(__VA_ARGS__); } while (0)
+#define	IF_myASSERT(f, c)			do { if (f) assert(c); } while (0)
+#define	IF_EXEC_2(f, x, a, b)		do { if (f) x(a, b); } while (0)
@@ -0,0 +1,5 @@
+// options.h - host stand-in, all run time options off
+
+#pragma once
+
+#define	OPT_GET(x)					0
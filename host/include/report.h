@@ -0,0 +1,19 @@
+// report.h - host stand-in: formatted reporting to stdout
+
+#pragma once
+
+#include "hal_platform.h"
+
+typedef struct report_t {
+	union {
+		u32_t u32Val;
+		struct {
+			u32_t jsIndent:1;
+		};
+	} sFM;
+} report_t;
+
+#define	makeMASK08_3x8(...)			0
+#define	fmTST(x)					(psR->sFM.x)
+
+int xReport(report_t * psR, const char * pcFormat, ...) __attribute__((format(printf, 2, 3)));
@@ -0,0 +1,5 @@
+// string_parse.h - host stand-in, nothing used by jsonX
+
+#pragma once
+
+#include "hal_platform.h"
@@ -0,0 +1,13 @@
+// string_to_values.h - host stand-in
+
+#pragma once
+
+#include "complex_vars.h"
+
+#define	pcFAILURE					((char *) -1)
+
+/**
+ * @brief	parse a value of type cvI from a NUL terminated string
+ * @return	pointer to first character not parsed or pcFAILURE
+ */
+char * cvParseValue(char * pSrc, cvi_e cvI, px_t pX);
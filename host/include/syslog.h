@@ -0,0 +1,8 @@
+// syslog.h - host stand-in, messages to stderr
+
+#pragma once
+
+#include "hal_platform.h"
+
+#define	SL_ERR(f, ...)				fprintf(stderr, "ERR " f "\n", ##__VA_ARGS__)
+#define	SL_WARN(f, ...)				fprintf(stderr, "WARN " f "\n", ##__VA_ARGS__)
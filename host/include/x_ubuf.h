@@ -0,0 +1,25 @@
+// x_ubuf.h - host stand-in: linear use of the ubuf_t API as used by jsonX
+
+#pragma once
+
+#include "hal_platform.h"
+
+typedef struct ubuf_t {
+	char * pBuf;
+	size_t IdxWR;
+	size_t IdxRD;
+	size_t Used;
+	size_t Size;
+} ubuf_t;
+
+static inline int xUBufGetSpace(ubuf_t * psUB) { return psUB->Size - psUB->Used; }
+static inline int xUBufGetUsed(ubuf_t * psUB) { return psUB->Used; }
+static inline char * pcUBufTellWrite(ubuf_t * psUB) { return psUB->pBuf + psUB->IdxWR; }
+static inline void vUBufStepWrite(ubuf_t * psUB, int Step) { psUB->IdxWR += Step; psUB->Used += Step; }
+static inline void vUBufReset(ubuf_t * psUB) { psUB->IdxWR = psUB->IdxRD = psUB->Used = 0; }
+
+/**
+ * @brief	formatted append, output truncated to the space available
+ * @return	number of characters written
+ */
+int uprintfx(ubuf_t * psUB, const char * pcFormat, ...) __attribute__((format(printf, 2, 3)));
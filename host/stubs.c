@@ -0,0 +1,52 @@
+/*
+ * stubs.c - host stand-ins for the support library functions used by jsonX
+ */
+
+#include "x_ubuf.h"
+#include "report.h"
+#include "string_to_values.h"
+
+#include <errno.h>
+#include <stdarg.h>
+
+int uprintfx(ubuf_t * psUB, const char * pcFormat, ...) {
+	size_t szSpace = psUB->Size - psUB->Used;
+	va_list vaList;
+	va_start(vaList, pcFormat);
+	int iRV = vsnprintf(psUB->pBuf + psUB->IdxWR, szSpace, pcFormat, vaList);
+	va_end(vaList);
+	if (iRV < 0)
+		return 0;
+	if ((size_t) iRV >= szSpace)
+		iRV = szSpace ? szSpace - 1 : 0;				// truncated, excl the NUL
+	vUBufStepWrite(psUB, iRV);
+	return iRV;
+}
+
+int xReport(report_t * psR, const char * pcFormat, ...) {
+	(void) psR;
+	va_list vaList;
+	va_start(vaList, pcFormat);
+	int iRV = vprintf(pcFormat, vaList);
+	va_end(vaList);
+	return iRV;
+}
+
+char * cvParseValue(char * pSrc, cvi_e cvI, px_t pX) {
+	char * pcEnd;
+	errno = 0;
+	switch (cvI) {
+	case cvU08: *pX.pu8 = strtoul(pSrc, &pcEnd, 10); break;
+	case cvU16: *pX.pu16 = strtoul(pSrc, &pcEnd, 10); break;
+	case cvU32: *pX.pu32 = strtoul(pSrc, &pcEnd, 10); break;
+	case cvU64: *pX.pu64 = strtoull(pSrc, &pcEnd, 10); break;
+	case cvI08: *pX.pi8 = strtol(pSrc, &pcEnd, 10); break;
+	case cvI16: *pX.pi16 = strtol(pSrc, &pcEnd, 10); break;
+	case cvI32: *pX.pi32 = strtol(pSrc, &pcEnd, 10); break;
+	case cvI64: *pX.pi64 = strtoll(pSrc, &pcEnd, 10); break;
+	case cvF32: *pX.pf32 = strtof(pSrc, &pcEnd); break;
+	case cvF64: *pX.pf64 = strtod(pSrc, &pcEnd); break;
+	default: return pcFAILURE;
+	}
+	return (pcEnd == pSrc || errno) ? pcFAILURE : pcEnd;
+}
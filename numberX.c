@@ -0,0 +1,529 @@
+/*
+ * numberX.c - Copyright 2014-25 Andre M. Maree / KSS Technologies (Pty) Ltd.
+ *
+ * Number formatting for the JSON writer.
+ *
+ * References:
+ *	Printing Floating-Point Numbers Quickly and Accurately with Integers, Florian Loitsch, PLDI 2010
+ *	Grisu2 as structured in https://github.com/nlohmann/json (dtoa_impl, MIT license)
+ */
+
+#include "hal_platform.h"
+#include "numberX.h"
+#include "errors_events.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+// ############################### BUILD: debug configuration options ##############################
+
+#define	debugFLAG					0xF000
+#define	debugTIMING					(debugFLAG_GLOBAL & debugFLAG & 0x1000)
+#define	debugTRACK					(debugFLAG_GLOBAL & debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG_GLOBAL & debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG_GLOBAL & debugFLAG & 0x8000)
+
+// ########################################## macros ###############################################
+
+#define	diyALPHA					-60					// target binary exponent range of scaled w
+#define	diyGAMMA					-32
+#define	diyMIN_DEC_EXP				-300				// cached powers range & step
+#define	diyDEC_STEP					8
+
+// ############################################ structures #########################################
+
+typedef struct { u64_t f; int e; } diyfp_t;				// f * 2^e
+typedef struct { u64_t f; i16_t e; i16_t k; } cpow_t;	// f * 2^e ~= 10^k
+
+// ###################################### local variables ##########################################
+
+static const char DigitPairs[200] = {
+	'0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+	'1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+	'2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+	'3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+	'4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+	'5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+	'6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+	'7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+	'8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+	'9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9',
+};
+
+// normalized 10^k for k = -300, -292 ... 324
+static const cpow_t CachedPowers[] = {
+	{ 0xAB70FE17C79AC6CAULL, -1060, -300 },
+	{ 0xFF77B1FCBEBCDC4FULL, -1034, -292 },
+	{ 0xBE5691EF416BD60CULL, -1007, -284 },
+	{ 0x8DD01FAD907FFC3CULL,  -980, -276 },
+	{ 0xD3515C2831559A83ULL,  -954, -268 },
+	{ 0x9D71AC8FADA6C9B5ULL,  -927, -260 },
+	{ 0xEA9C227723EE8BCBULL,  -901, -252 },
+	{ 0xAECC49914078536DULL,  -874, -244 },
+	{ 0x823C12795DB6CE57ULL,  -847, -236 },
+	{ 0xC21094364DFB5637ULL,  -821, -228 },
+	{ 0x9096EA6F3848984FULL,  -794, -220 },
+	{ 0xD77485CB25823AC7ULL,  -768, -212 },
+	{ 0xA086CFCD97BF97F4ULL,  -741, -204 },
+	{ 0xEF340A98172AACE5ULL,  -715, -196 },
+	{ 0xB23867FB2A35B28EULL,  -688, -188 },
+	{ 0x84C8D4DFD2C63F3BULL,  -661, -180 },
+	{ 0xC5DD44271AD3CDBAULL,  -635, -172 },
+	{ 0x936B9FCEBB25C996ULL,  -608, -164 },
+	{ 0xDBAC6C247D62A584ULL,  -582, -156 },
+	{ 0xA3AB66580D5FDAF6ULL,  -555, -148 },
+	{ 0xF3E2F893DEC3F126ULL,  -529, -140 },
+	{ 0xB5B5ADA8AAFF80B8ULL,  -502, -132 },
+	{ 0x87625F056C7C4A8BULL,  -475, -124 },
+	{ 0xC9BCFF6034C13053ULL,  -449, -116 },
+	{ 0x964E858C91BA2655ULL,  -422, -108 },
+	{ 0xDFF9772470297EBDULL,  -396, -100 },
+	{ 0xA6DFBD9FB8E5B88FULL,  -369,  -92 },
+	{ 0xF8A95FCF88747D94ULL,  -343,  -84 },
+	{ 0xB94470938FA89BCFULL,  -316,  -76 },
+	{ 0x8A08F0F8BF0F156BULL,  -289,  -68 },
+	{ 0xCDB02555653131B6ULL,  -263,  -60 },
+	{ 0x993FE2C6D07B7FACULL,  -236,  -52 },
+	{ 0xE45C10C42A2B3B06ULL,  -210,  -44 },
+	{ 0xAA242499697392D3ULL,  -183,  -36 },
+	{ 0xFD87B5F28300CA0EULL,  -157,  -28 },
+	{ 0xBCE5086492111AEBULL,  -130,  -20 },
+	{ 0x8CBCCC096F5088CCULL,  -103,  -12 },
+	{ 0xD1B71758E219652CULL,   -77,   -4 },
+	{ 0x9C40000000000000ULL,   -50,    4 },
+	{ 0xE8D4A51000000000ULL,   -24,   12 },
+	{ 0xAD78EBC5AC620000ULL,     3,   20 },
+	{ 0x813F3978F8940984ULL,    30,   28 },
+	{ 0xC097CE7BC90715B3ULL,    56,   36 },
+	{ 0x8F7E32CE7BEA5C70ULL,    83,   44 },
+	{ 0xD5D238A4ABE98068ULL,   109,   52 },
+	{ 0x9F4F2726179A2245ULL,   136,   60 },
+	{ 0xED63A231D4C4FB27ULL,   162,   68 },
+	{ 0xB0DE65388CC8ADA8ULL,   189,   76 },
+	{ 0x83C7088E1AAB65DBULL,   216,   84 },
+	{ 0xC45D1DF942711D9AULL,   242,   92 },
+	{ 0x924D692CA61BE758ULL,   269,  100 },
+	{ 0xDA01EE641A708DEAULL,   295,  108 },
+	{ 0xA26DA3999AEF774AULL,   322,  116 },
+	{ 0xF209787BB47D6B85ULL,   348,  124 },
+	{ 0xB454E4A179DD1877ULL,   375,  132 },
+	{ 0x865B86925B9BC5C2ULL,   402,  140 },
+	{ 0xC83553C5C8965D3DULL,   428,  148 },
+	{ 0x952AB45CFA97A0B3ULL,   455,  156 },
+	{ 0xDE469FBD99A05FE3ULL,   481,  164 },
+	{ 0xA59BC234DB398C25ULL,   508,  172 },
+	{ 0xF6C69A72A3989F5CULL,   534,  180 },
+	{ 0xB7DCBF5354E9BECEULL,   561,  188 },
+	{ 0x88FCF317F22241E2ULL,   588,  196 },
+	{ 0xCC20CE9BD35C78A5ULL,   614,  204 },
+	{ 0x98165AF37B2153DFULL,   641,  212 },
+	{ 0xE2A0B5DC971F303AULL,   667,  220 },
+	{ 0xA8D9D1535CE3B396ULL,   694,  228 },
+	{ 0xFB9B7CD9A4A7443CULL,   720,  236 },
+	{ 0xBB764C4CA7A44410ULL,   747,  244 },
+	{ 0x8BAB8EEFB6409C1AULL,   774,  252 },
+	{ 0xD01FEF10A657842CULL,   800,  260 },
+	{ 0x9B10A4E5E9913129ULL,   827,  268 },
+	{ 0xE7109BFBA19C0C9DULL,   853,  276 },
+	{ 0xAC2820D9623BF429ULL,   880,  284 },
+	{ 0x80444B5E7AA7CF85ULL,   907,  292 },
+	{ 0xBF21E44003ACDD2DULL,   933,  300 },
+	{ 0x8E679C2F5E44FF8FULL,   960,  308 },
+	{ 0xD433179D9C8CB841ULL,   986,  316 },
+	{ 0x9E19DB92B4E31BA9ULL,  1013,  324 },
+};
+
+static const u64_t Pow10[jsonDECIMALS_MAX + 1] = {
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+	1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+	100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+};
+
+// exactly representable powers of 10 for the fast path
+static const f64_t F64Pow10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+// ####################################### Integer formatting ######################################
+
+int xJsonFormatU64(char * pcBuf, u64_t U64) {
+	char caTmp[20];
+	char * pcNow = caTmp + sizeof(caTmp);
+	while (U64 >= 100) {								// 2 digits per division
+		u32_t Idx = (u32_t) (U64 % 100) * 2;
+		U64 /= 100;
+		*--pcNow = DigitPairs[Idx + 1];
+		*--pcNow = DigitPairs[Idx];
+	}
+	if (U64 >= 10) {
+		*--pcNow = DigitPairs[U64 * 2 + 1];
+		*--pcNow = DigitPairs[U64 * 2];
+	} else {
+		*--pcNow = '0' + U64;
+	}
+	int Len = caTmp + sizeof(caTmp) - pcNow;
+	memcpy(pcBuf, pcNow, Len);
+	return Len;
+}
+
+int xJsonFormatI64(char * pcBuf, i64_t I64) {
+	if (I64 >= 0)
+		return xJsonFormatU64(pcBuf, I64);
+	*pcBuf = '-';
+	return 1 + xJsonFormatU64(pcBuf + 1, 0ULL - (u64_t) I64);
+}
+
+// ############################## Grisu2 shortest round trip formatting ############################
+
+static diyfp_t xDiyMul(diyfp_t X, diyfp_t Y) {
+	u64_t uLo = X.f & 0xFFFFFFFFULL, uHi = X.f >> 32;
+	u64_t vLo = Y.f & 0xFFFFFFFFULL, vHi = Y.f >> 32;
+	u64_t P0 = uLo * vLo, P1 = uLo * vHi, P2 = uHi * vLo, P3 = uHi * vHi;
+	u64_t Q = (P0 >> 32) + (P1 & 0xFFFFFFFFULL) + (P2 & 0xFFFFFFFFULL) + (1ULL << 31);	// rounded
+	return (diyfp_t) { P3 + (P2 >> 32) + (P1 >> 32) + (Q >> 32), X.e + Y.e + 64 };
+}
+
+static diyfp_t xDiyNormalize(diyfp_t X) {
+	while ((X.f >> 63) == 0) {
+		X.f <<= 1;
+		--X.e;
+	}
+	return X;
+}
+
+/**
+ * @brief	compute normalized value and boundaries (m- & m+ share exponent) of a binary float
+ * @param	F - significand bits (excl hidden bit)
+ * @param	E - biased exponent bits
+ * @param	Digits - significand precision incl hidden bit (53 or 24)
+ * @param	Bias - exponent bias + Digits - 1
+ */
+static void xDiyBoundaries(u64_t F, int E, int Digits, int Bias, diyfp_t * psMinus, diyfp_t * psV, diyfp_t * psPlus) {
+	u64_t Hidden = 1ULL << (Digits - 1);
+	diyfp_t V = (E == 0) ? (diyfp_t) { F, 1 - Bias } : (diyfp_t) { F + Hidden, E - Bias };
+	int fCloser = (F == 0) && (E > 1);					// lower boundary closer if at power of 2
+	diyfp_t Plus = xDiyNormalize((diyfp_t) { (V.f << 1) + 1, V.e - 1 });
+	diyfp_t Minus = fCloser ? (diyfp_t) { (V.f << 2) - 1, V.e - 2 } : (diyfp_t) { (V.f << 1) - 1, V.e - 1 };
+	Minus.f <<= (Minus.e - Plus.e);
+	Minus.e = Plus.e;
+	*psMinus = Minus;
+	*psV = xDiyNormalize(V);
+	*psPlus = Plus;
+}
+
+static void vGrisuRound(char * pcBuf, int Len, u64_t Dist, u64_t Delta, u64_t Rest, u64_t TenK) {
+	while (Rest < Dist && (Delta - Rest) >= TenK && ((Rest + TenK) < Dist || (Dist - Rest) > (Rest + TenK - Dist))) {
+		--pcBuf[Len - 1];
+		Rest += TenK;
+	}
+}
+
+/**
+ * @brief	generate shortest digits of V within (M-, M+)
+ * @return	number of digits, *pDecExp adjusted such that value = digits * 10^DecExp
+ */
+static int xGrisuDigits(char * pcBuf, int * pDecExp, diyfp_t Minus, diyfp_t W, diyfp_t Plus) {
+	u64_t Delta = Plus.f - Minus.f;
+	u64_t Dist = Plus.f - W.f;
+	int Shift = -Plus.e;
+	u64_t One = 1ULL << Shift;
+	u32_t P1 = (u32_t) (Plus.f >> Shift);				// integral part
+	u64_t P2 = Plus.f & (One - 1);						// fractional part
+	int Len = 0, N = 10;
+	while (N > 1 && P1 < Pow10[N - 1])					// number of digits in integral part
+		--N;
+	u32_t Div = (u32_t) Pow10[N - 1];
+	while (N > 0) {
+		pcBuf[Len++] = '0' + (P1 / Div);
+		P1 %= Div;
+		--N;
+		u64_t Rest = ((u64_t) P1 << Shift) + P2;
+		if (Rest <= Delta) {
+			*pDecExp += N;
+			vGrisuRound(pcBuf, Len, Dist, Delta, Rest, (u64_t) Div << Shift);
+			return Len;
+		}
+		Div /= 10;
+	}
+	int M = 0;
+	for (;;) {
+		P2 *= 10;
+		pcBuf[Len++] = '0' + (char) (P2 >> Shift);
+		P2 &= One - 1;
+		++M;
+		Delta *= 10;
+		Dist *= 10;
+		if (P2 <= Delta)
+			break;
+	}
+	*pDecExp -= M;
+	vGrisuRound(pcBuf, Len, Dist, Delta, P2, One);
+	return Len;
+}
+
+static int xGrisu2(char * pcBuf, int * pDecExp, diyfp_t Minus, diyfp_t V, diyfp_t Plus) {
+	// select cached power such that scaled exponent lands in [diyALPHA, diyGAMMA]
+	int F = diyALPHA - Plus.e - 1;
+	int K = (F * 78913) / (1 << 18) + (F > 0);			// ceil(F * log10(2))
+	int Idx = (-diyMIN_DEC_EXP + K + (diyDEC_STEP - 1)) / diyDEC_STEP;
+	const cpow_t * psCP = &CachedPowers[Idx];
+	diyfp_t C = { psCP->f, psCP->e };
+	diyfp_t W = xDiyMul(V, C), wMinus = xDiyMul(Minus, C), wPlus = xDiyMul(Plus, C);
+	// shrink the interval by 1 ulp each side, compensates for rounding in xDiyMul()
+	wMinus.f += 1;
+	wPlus.f -= 1;
+	*pDecExp = -psCP->k;
+	return xGrisuDigits(pcBuf, pDecExp, wMinus, W, wPlus);
+}
+
+/**
+ * @brief	lay out Len digits * 10^DecExp as plain or exponent notation
+ * @return	number of characters in buffer
+ */
+static int xFormatDigits(char * pcBuf, int Len, int DecExp, int MaxExp) {
+	int N = Len + DecExp;								// position of decimal point
+	if (Len <= N && N <= MaxExp) {						// digits[000]
+		memset(pcBuf + Len, '0', N - Len);
+		return N;
+	}
+	if (0 < N && N <= MaxExp) {							// dig.its
+		memmove(pcBuf + N + 1, pcBuf + N, Len - N);
+		pcBuf[N] = '.';
+		return Len + 1;
+	}
+	if (-4 < N && N <= 0) {								// 0.[000]digits
+		memmove(pcBuf + 2 - N, pcBuf, Len);
+		pcBuf[0] = '0';
+		pcBuf[1] = '.';
+		memset(pcBuf + 2, '0', -N);
+		return 2 - N + Len;
+	}
+	int Pos = 1;										// d[.igits]e[-]xx
+	if (Len > 1) {
+		memmove(pcBuf + 2, pcBuf + 1, Len - 1);
+		pcBuf[1] = '.';
+		Pos = Len + 1;
+	}
+	pcBuf[Pos++] = 'e';
+	return Pos + xJsonFormatI64(pcBuf + Pos, N - 1);
+}
+
+/**
+ * @brief	fixed decimals, integer arithmetic if scaled value fits else stdio
+ */
+static int xFormatFixed(char * pcBuf, f64_t F64, int Decimals) {
+	f64_t Scaled = F64 * (f64_t) Pow10[Decimals];
+	if (Scaled > -9.0e18 && Scaled < 9.0e18) {
+		int Len = 0;
+		if (Scaled < 0) {
+			pcBuf[Len++] = '-';
+			Scaled = -Scaled;
+		}
+		u64_t U64 = (u64_t) (Scaled + 0.5);
+		if (U64 == 0 && Len)
+			Len = 0;									// no "-0.00"
+		Len += xJsonFormatU64(pcBuf + Len, U64 / Pow10[Decimals]);
+		if (Decimals) {
+			char caTmp[20];
+			int Frac = xJsonFormatU64(caTmp, U64 % Pow10[Decimals]);
+			pcBuf[Len++] = '.';
+			memset(pcBuf + Len, '0', Decimals - Frac);	// leading zeroes of fraction
+			memcpy(pcBuf + Len + Decimals - Frac, caTmp, Frac);
+			Len += Decimals;
+		}
+		return Len;
+	}
+	return snprintf(pcBuf, jsonNUM_BUF_SIZE, "%.*g", 17, F64);
+}
+
+/**
+ * @brief	common sign, zero, NaN/Inf & fixed decimals handling
+ * @return	characters written, or < 0 if shortest format to be generated
+ */
+static int xFormatSpecial(char * pcBuf, f64_t F64, int fNeg, int fFinite, int Decimals) {
+	if (fFinite == 0) {									// NaN & Inf not representable in JSON
+		memcpy(pcBuf, "null", 4);
+		return 4;
+	}
+	Decimals = xJsonDecimals(Decimals);
+	if (Decimals != jsonDECIMALS_SHORTEST)
+		return xFormatFixed(pcBuf, F64, Decimals);
+	if (F64 == 0.0) {
+		if (fNeg)
+			*pcBuf++ = '-';
+		*pcBuf = '0';
+		return 1 + fNeg;
+	}
+	return -1;
+}
+
+int xJsonDecimals(int Decimals) {
+	return (Decimals == jsonDECIMALS_SHORTEST || (Decimals >= 0 && Decimals <= jsonDECIMALS_MAX)) ? Decimals : jsonDECIMALS_DEFAULT;
+}
+
+int xJsonFormatF64(char * pcBuf, f64_t F64, int Decimals) {
+	u64_t Bits;
+	memcpy(&Bits, &F64, sizeof(Bits));
+	int fNeg = Bits >> 63, E = (Bits >> 52) & 0x7FF;
+	int Len = xFormatSpecial(pcBuf, F64, fNeg, E != 0x7FF, Decimals);
+	if (Len >= 0)
+		return Len;
+	if (fNeg)
+		*pcBuf++ = '-';
+	diyfp_t Minus, V, Plus;
+	xDiyBoundaries(Bits & ((1ULL << 52) - 1), E, 53, 1075, &Minus, &V, &Plus);
+	int DecExp;
+	Len = xGrisu2(pcBuf, &DecExp, Minus, V, Plus);
+	return fNeg + xFormatDigits(pcBuf, Len, DecExp, 15);
+}
+
+int xJsonFormatF32(char * pcBuf, f32_t F32, int Decimals) {
+	u32_t Bits;
+	memcpy(&Bits, &F32, sizeof(Bits));
+	int fNeg = Bits >> 31, E = (Bits >> 23) & 0xFF;
+	int Len = xFormatSpecial(pcBuf, F32, fNeg, E != 0xFF, Decimals);
+	if (Len >= 0)
+		return Len;
+	if (fNeg)
+		*pcBuf++ = '-';
+	diyfp_t Minus, V, Plus;								// boundaries of the float, not of the double
+	xDiyBoundaries(Bits & ((1UL << 23) - 1), E, 24, 150, &Minus, &V, &Plus);
+	int DecExp;
+	Len = xGrisu2(pcBuf, &DecExp, Minus, V, Plus);
+	return fNeg + xFormatDigits(pcBuf, Len, DecExp, 7);
+}
+
+// ######################################## Number parsing #########################################
+
+/**
+ * @brief	parse a floating point span, exact fast path for short mantissa & small exponent
+ * @note	Accepts -?digits[.[digits]][(e|E)[+|-]digits], ie JSON plus leading zeros & "1."
+ * @return	erSUCCESS or erFAILURE if syntax error or value out of range (infinite) for the type
+ */
+static int xParseF64(const char * pcBuf, size_t szBuf, f64_t * pF64, f32_t * pF32) {
+	const char * pcNow = pcBuf, * pcEnd = pcBuf + szBuf;
+	int fNeg = (pcNow < pcEnd && *pcNow == '-');
+	pcNow += fNeg;
+	if (pcNow == pcEnd || !INRANGE('0', *pcNow, '9'))	// at least 1 integer digit
+		return erFAILURE;
+	u64_t Mant = 0;
+	int Digits = 0, Exp10 = 0, fFrac = 0;
+	for (; pcNow < pcEnd; ++pcNow) {
+		if (INRANGE('0', *pcNow, '9')) {
+			if (Digits < 19) {							// beyond 19 digits use slow path
+				Mant = (Mant * 10) + (*pcNow - '0');
+				Digits += (Mant != 0);
+				Exp10 -= fFrac;
+			} else {
+				Digits = 20;
+			}
+		} else if (*pcNow == '.' && fFrac == 0) {
+			fFrac = 1;
+		} else {
+			break;
+		}
+	}
+	if (pcNow < pcEnd && (*pcNow == 'e' || *pcNow == 'E')) {
+		int fENeg = 0, Exp = 0;
+		if (++pcNow < pcEnd && (*pcNow == '-' || *pcNow == '+'))
+			fENeg = (*pcNow++ == '-');
+		if (pcNow == pcEnd)
+			return erFAILURE;
+		for (; pcNow < pcEnd && INRANGE('0', *pcNow, '9'); ++pcNow)
+			Exp = (Exp < 10000) ? (Exp * 10) + (*pcNow - '0') : Exp;
+		Exp10 += fENeg ? -Exp : Exp;
+	}
+	if (pcNow != pcEnd)
+		return erFAILURE;
+	if (pF32 && Digits <= 7 && INRANGE(-10, Exp10, 10)) {	// exact in float arithmetic
+		f32_t F32 = (f32_t) Mant;
+		F32 = (Exp10 < 0) ? (F32 / (f32_t) F64Pow10[-Exp10]) : (F32 * (f32_t) F64Pow10[Exp10]);
+		*pF32 = fNeg ? -F32 : F32;
+		return erSUCCESS;
+	}
+	if (pF64 && Digits <= 15 && INRANGE(-22, Exp10, 22)) {	// exact in double arithmetic
+		f64_t F64 = (f64_t) Mant;
+		F64 = (Exp10 < 0) ? (F64 / F64Pow10[-Exp10]) : (F64 * F64Pow10[Exp10]);
+		*pF64 = fNeg ? -F64 : F64;
+		return erSUCCESS;
+	}
+	char caTmp[64];										// slow path, correctly rounded by libc
+	char * pcTmp = (szBuf < sizeof(caTmp)) ? caTmp : malloc(szBuf + 1);	// long mantissa, rare
+	if (pcTmp == NULL)
+		return erFAILURE;
+	memcpy(pcTmp, pcBuf, szBuf);
+	pcTmp[szBuf] = CHR_NUL;
+	int iRV = erSUCCESS;
+	if (pF32) {
+		f32_t F32 = strtof(pcTmp, NULL);
+		if (isinf(F32))									// overflows float
+			iRV = erFAILURE;
+		else
+			*pF32 = F32;
+	} else {
+		f64_t F64 = strtod(pcTmp, NULL);
+		if (isinf(F64))
+			iRV = erFAILURE;
+		else
+			*pF64 = F64;
+	}
+	if (pcTmp != caTmp)
+		free(pcTmp);
+	return iRV;
+}
+
+int xJsonParseNumber(const char * pcBuf, size_t szBuf, px_t pX, cvi_e cvI) {
+	if (cvI == cvF32)
+		return xParseF64(pcBuf, szBuf, NULL, pX.pf32);
+	if (cvI == cvF64)
+		return xParseF64(pcBuf, szBuf, pX.pf64, NULL);
+	if (cvI > cvI64)
+		return erFAILURE;
+	// Integer fast path: [-]digits with overflow detection
+	const char * pcNow = pcBuf, * pcEnd = pcBuf + szBuf;
+	int fNeg = (pcNow < pcEnd && *pcNow == '-');
+	pcNow += fNeg;
+	u64_t U64 = 0;
+	if (pcNow == pcEnd)
+		return erFAILURE;
+	for (; pcNow < pcEnd && INRANGE('0', *pcNow, '9'); ++pcNow) {
+		u32_t Digit = *pcNow - '0';
+		if (U64 > (UINT64_MAX - Digit) / 10)
+			return erFAILURE;							// overflows 64 bits
+		U64 = (U64 * 10) + Digit;
+	}
+	if (pcNow != pcEnd) {								// fraction and/or exponent, accept if integral
+		f64_t F64;
+		if (xParseF64(pcBuf, szBuf, &F64, NULL) != erSUCCESS || F64 >= 9.2e18 || F64 <= -9.2e18 || F64 != (f64_t) (i64_t) F64)
+			return erFAILURE;
+		fNeg = (F64 < 0);
+		U64 = fNeg ? (u64_t) -(i64_t) F64 : (u64_t) F64;
+	}
+	if (cvI < cvI08) {									// unsigned, range check for target width
+		static const u64_t UMax[] = { UINT8_MAX, UINT16_MAX, UINT32_MAX, UINT64_MAX };
+		if ((fNeg && U64) || U64 > UMax[cvI - cvU08])
+			return erFAILURE;
+		switch(cvI) {
+		case cvU08:	*pX.pu8 = U64; break;
+		case cvU16:	*pX.pu16 = U64; break;
+		case cvU32:	*pX.pu32 = U64; break;
+		default:	*pX.pu64 = U64; break;
+		}
+		return erSUCCESS;
+	}
+	static const u64_t IMax[] = { INT8_MAX, INT16_MAX, INT32_MAX, INT64_MAX };
+	u64_t Max = IMax[cvI - cvI08];
+	if (U64 > (Max + fNeg))								// negative range is 1 larger
+		return erFAILURE;
+	i64_t I64 = fNeg ? (i64_t) (0ULL - U64) : (i64_t) U64;
+	switch(cvI) {
+	case cvI08:	*pX.pi8 = I64; break;
+	case cvI16:	*pX.pi16 = I64; break;
+	case cvI32:	*pX.pi32 = I64; break;
+	default:	*pX.pi64 = I64; break;
+	}
+	return erSUCCESS;
+}
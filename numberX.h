@@ -0,0 +1,56 @@
+// numberX.h
+
+#pragma once
+
+#include "complex_vars.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ########################################## macros ###############################################
+
+#define	jsonNUM_BUF_SIZE			32					// largest formatted number incl sign & exponent
+#define	jsonDECIMALS_SHORTEST		-1					// shortest representation that round trips
+#define	jsonDECIMALS_MAX			17					// fixed decimals, f64 precision exhausted beyond
+#define	jsonDECIMALS_DEFAULT		jsonDECIMALS_SHORTEST	// initial & invalid setting, f32, f64 & writer
+
+// ####################################### global functions ########################################
+
+/**
+ * @brief	format unsigned/signed integers, digit pair table based
+ * @param	pcBuf - output, at least jsonNUM_BUF_SIZE bytes, not terminated
+ * @return	number of characters written
+ */
+int xJsonFormatU64(char * pcBuf, u64_t U64);
+int xJsonFormatI64(char * pcBuf, i64_t I64);
+
+/**
+ * @brief	validate a float decimals setting
+ * @return	Decimals if jsonDECIMALS_SHORTEST or 0 -> jsonDECIMALS_MAX, else jsonDECIMALS_DEFAULT
+ */
+int xJsonDecimals(int Decimals);
+
+/**
+ * @brief	format double/float value, NaN & Inf written as null
+ * @param	pcBuf - output, at least jsonNUM_BUF_SIZE bytes, not terminated
+ * @param	Decimals - jsonDECIMALS_SHORTEST for shortest round trip (Grisu2) else fixed decimals,
+ *			invalid values as per xJsonDecimals()
+ * @return	number of characters written
+ */
+int xJsonFormatF64(char * pcBuf, f64_t F64, int Decimals);
+int xJsonFormatF32(char * pcBuf, f32_t F32, int Decimals);
+
+/**
+ * @brief	parse a number from an exact span (eg token start/end), no terminator required
+ * @param	pcBuf - first character of number
+ * @param	szBuf - number of characters in span
+ * @param	pX - pointer to variable of type cvI (cvU08 -> cvF64) to be updated
+ * @return	erSUCCESS or erFAILURE if syntax error, out of range for the type or unsupported type
+ * @note	Integer types accept fraction/exponent forms only if the value is integral and in range
+ */
+int xJsonParseNumber(const char * pcBuf, size_t szBuf, px_t pX, cvi_e cvI);
+
+#ifdef __cplusplus
+}
+#endif
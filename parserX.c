@@ -12,6 +12,9 @@
 #include "errors_events.h"
 #include "string_parse.h"
 #include "string_to_values.h"
+#include "numberX.h"
+#include "statsX.h"
+#include "writerX.h"
 
 #include <string.h>
 
@@ -24,6 +27,14 @@
 #define	debugPARAM					(debugFLAG_GLOBAL & debugFLAG & 0x4000)
 #define	debugRESULT					(debugFLAG_GLOBAL & debugFLAG & 0x8000)
 
+#define	jsonREPORT_BUF_SIZE			128					// xJsonReportTokens() output chunk
+
+#if (jsonTOKEN_COMPACT == 1)
+	#define	jsonTOKENISE			xJsonTokenise
+#else
+	#define	jsonTOKENISE			jsmn_parse
+#endif
+
 const char * tokType[] = { "Undef", "Object", "Array", "", "String", "", "", "", "Value" };
 
 // ####################################### Global Functions ########################################
@@ -43,17 +54,6 @@ static int xJsonPrintToken(report_t * psR,  parse_hdlr_t * psPH) {
 	return iRV;
 }
 
-static int xJsonPrintIndent(report_t * psR, int Depth, int Sep, int CR0, int CR1) {
-	int iRV = 0;
-	if (CR0) iRV += xReport(psR, strNL);
-//	iRV += xReport(psR, "%*s", Depth * psR->sFM.jsIndent, " ");
-	for (int x = 0; x < Depth; ++x) iRV += xReport(psR, "  ");
-	if (Sep) iRV += xReport(psR, " %c", Sep);
-	if (CR0) iRV += xReport(psR, "(s=%d)", CR0);
-	if (CR1) iRV += xReport(psR, strNL);
-	return iRV;
-}
-
 void xJsonPrintCurTok(report_t * psR, parse_hdlr_t * psPH, const char * pLabel) {
 	report_t sRprt = { .sFM.u32Val = makeMASK08_3x8(0,0,0,0,0,0,0,0,2,0,0) };
 	if (psR == NULL)
@@ -64,96 +64,232 @@ void xJsonPrintCurTok(report_t * psR, parse_hdlr_t * psPH, const char * pLabel)
 }
 
 /**
- * Iterates through the token list and prints all tokens, type, size and actual value
- * @param psP
- * @param psPH
- * @param Depth
- * @return
+ * @brief	ensure the token array can hold at least Need tokens (incl spare), preserving parsed tokens
+ * @param	psPH - parse handler
+ * @param	Need - minimum number of tokens required
+ * @return	erSUCCESS or erFAILURE if memory could not be allocated
  */
-static int xJsonReportTokensRecurse(report_t * psR, parse_hdlr_t * psPH, jsmntok_t * pasTL, int Count, int Depth) {
-	IF_myASSERT(debugTRACK, psR);
-//	if (Count == 0) return 0;
-	int iRV;
-	if (pasTL->type == JSMN_PRIMITIVE || pasTL->type == JSMN_STRING) {
-		xReport(psR, "%d/%s='%.*s'", pasTL->type, tokType[pasTL->type], pasTL->end - pasTL->start, psPH->pcBuf + pasTL->start);
-		iRV = 1;
-	} else if (pasTL->type == JSMN_OBJECT) {
-		if (fmTST(jsIndent))
-			xJsonPrintIndent(psR, Depth, CHR_L_CURLY, pasTL->size, 1);
-		int j = 0;
-		for (int i = 0; i < pasTL->size; ++i) {
-			if (fmTST(jsIndent))
-				xJsonPrintIndent(psR, Depth+2, 0, 0, 0);
-			j += xJsonReportTokensRecurse(psR, psPH, pasTL+j+1, Count-j, Depth+1);
-			xReport(psR, " : ");
-			j += xJsonReportTokensRecurse(psR, psPH, pasTL+j+1, Count-j, Depth+1);
-			xReport(psR, strNL);
-		}
-		if (fmTST(jsIndent))
-			xJsonPrintIndent(psR, Depth, CHR_R_CURLY, 0, 0);
-		iRV = j + 1;
-	} else if (pasTL->type == JSMN_ARRAY) {
-		if (fmTST(jsIndent))
-			xJsonPrintIndent(psR, Depth, CHR_L_SQUARE, pasTL->size, 1);
-		int j = 0;
-		for (int i = 0; i < pasTL->size; ++i) {
-			if (fmTST(jsIndent))
-				xJsonPrintIndent(psR, Depth+2, 0, 0, 0);
-			j += xJsonReportTokensRecurse(psR, psPH, pasTL+j+1, Count-j, Depth+1);
-			xReport(psR, strNL);
-		}
-		if (fmTST(jsIndent))
-			xJsonPrintIndent(psR, Depth, CHR_R_SQUARE, 0, 0);
-		iRV = j + 1;
-	} else {
-		iRV = 0;
-		xReport(psR, strNL);
+static int xJsonGrowTokens(parse_hdlr_t * psPH, int Need) {
+	if (Need <= psPH->MaxTok)
+		return erSUCCESS;
+	int NewMax = (psPH->MaxTok > jsonMIN_TOKENS) ? psPH->MaxTok : jsonMIN_TOKENS;
+	while (NewMax < Need)
+		NewMax *= 2;
+	jsontok_t * psNew;
+	if (psPH->fArena) {									// own arena, grow in place if possible
+		psNew = (jsontok_t *) realloc(psPH->psT0, NewMax * sizeof(jsontok_t));
+	} else {											// caller pool (or none), move to own arena
+		psNew = (jsontok_t *) malloc(NewMax * sizeof(jsontok_t));
+		if (psNew && psPH->MaxTok && psPH->sParser.toknext)
+			memcpy(psNew, psPH->psT0, psPH->sParser.toknext * sizeof(jsontok_t));
 	}
-	return iRV;
+	IF_myASSERT(debugRESULT, psNew);
+	if (psNew == NULL)
+		return erFAILURE;
+	jsonSTAT_ADD(TokAllocBytes, NewMax * sizeof(jsontok_t));
+	psPH->psT0 = psNew;
+	psPH->MaxTok = NewMax;
+	psPH->fArena = 1;
+	return erSUCCESS;
 }
 
-int xJsonReportTokens(parse_hdlr_t * psPH, int Depth) {
-	report_t sRprt = { .sFM.u32Val = makeMASK08_3x8(0,0,0,0,0,0,0,0,2,0,0) };
-	psPH->CurTok = 0;
-	psPH->psTx = &psPH->psT0[psPH->CurTok];
-	return xJsonReportTokensRecurse(&sRprt, psPH, psPH->psTx, 0, Depth);
+void vJsonParseInit(parse_hdlr_t * psPH, jsontok_t * psPool, int MaxTok) {
+	psPH->psT0 = psPool;
+	psPH->MaxTok = psPool ? MaxTok : 0;
+	psPH->piIdx = NULL;
+	psPH->szIdx = 0;
+	psPH->piNext = NULL;
+	psPH->szNext = 0;
+	psPH->puDec = NULL;
+	psPH->szDec = 0;
+	psPH->Flags = 0;
+	vJsonParseReset(psPH);
+}
+
+void vJsonParseReset(parse_hdlr_t * psPH) {
+	if (psPH->fMapped) {								// tokens (& index) mapped, detach, never grow or free
+		psPH->psT0 = NULL;
+		psPH->MaxTok = 0;
+		if (psPH->szIdx == 0)
+			psPH->piIdx = NULL;
+		psPH->fMapped = 0;
+	}
+	jsmn_init(&psPH->sParser);
+	psPH->psTx = NULL;
+	psPH->NumTok = psPH->CurTok = 0;
+	psPH->MaskIdx = 0;
+	psPH->NumNext = 0;
+	if (psPH->puDec)
+		memset(psPH->puDec, 0, psPH->szDec * sizeof(u32_t));
+	psPH->fFeed = 0;
+}
+
+void vJsonParseRelease(parse_hdlr_t * psPH) {
+	if (psPH->fMapped)
+		vJsonParseReset(psPH);
+	if (psPH->fArena)
+		free(psPH->psT0);
+	free(psPH->piIdx);
+	free(psPH->piNext);
+	free(psPH->puDec);
+	vJsonParseInit(psPH, NULL, 0);
 }
 
 /**
- * @brief	parser to determines # of tokens, allocate memory and recalls parser with buffer
- * @param	pBuf
- * @param	xLen
- * @param	pParser
- * @param	ppTokenList
- * @return	number of tokens parsed, 0 or less if error
+ * @brief	(Continue to) tokenise the first Len bytes of pcBuf, growing the token arena on overflow
+ * @return	jsmn_parse() result
  */
-int xJsonParse(parse_hdlr_t * psPH) {
-	#define jsonEXTRA_SIZE	5
-	// count tokens to determine buffer to be allocated
-	jsmn_init(&psPH->sParser);
-	int iRV = jsmn_parse(&psPH->sParser, psPH->pcBuf, psPH->szBuf, NULL, 0);
+static int xJsonParseTokens(parse_hdlr_t * psPH, size_t Len) {
+	int iRV;
+	do {	// on overflow grow and resume from where jsmn stopped
+		iRV = jsonTOKENISE(&psPH->sParser, psPH->pcBuf, Len, psPH->psT0, psPH->MaxTok - jsonEXTRA_SIZE);
+	} while (iRV == JSMN_ERROR_NOMEM && xJsonGrowTokens(psPH, psPH->MaxTok * 2) == erSUCCESS);
+	psPH->NumTok = psPH->sParser.toknext;
+	// spare space at the end (all ZEROS ie JSMN_UNDEFINED)
+	memset(&psPH->psT0[psPH->NumTok], 0, jsonEXTRA_SIZE * sizeof(jsontok_t));
 	if (iRV > 0) {
-		psPH->NumTok = iRV;
-		// Allocate memory, add spare space at the end (all ZEROS ie JSMN_UNDEFINED)
-		psPH->psT0 = (jsmntok_t *) calloc(iRV+jsonEXTRA_SIZE, sizeof(jsmntok_t));
-		IF_myASSERT(debugRESULT, psPH->psT0);
-		// perform the actual parsing process
-		jsmn_init(&psPH->sParser);
-		iRV = jsmn_parse(&psPH->sParser, psPH->pcBuf, psPH->szBuf, psPH->psT0, iRV+jsonEXTRA_SIZE);
-		if (psPH->NumTok != iRV)
-			SL_ERR("Incomplete parsing %d vs %d", iRV, psPH->NumTok);
+		jsonSTAT_ADD(ParseTokens, psPH->NumTok);
+		jsonSTAT_ADD(ParseBytes, Len);
 		IF_EXEC_2(debugPARSE, xJsonReportTokens, psPH, 0);
+		if (psPH->fIndex)
+			xJsonIndexBuild(psPH);
+	}
+	return iRV;
+}
+
+int xJsonParse(parse_hdlr_t * psPH) {
+	jsonSTAT_T0(T0);
+	vJsonParseReset(psPH);
+	// no token memory attached (or legacy zeroed handler), estimate initial arena from source size
+	int Need = jsonEXTRA_SIZE + 1;
+	if (psPH->MaxTok == 0) {
+		psPH->fArena = 0;								// psT0 (if any) is not ours to reuse
+		Need += psPH->szBuf / jsonBYTES_PER_TOKEN;
 	}
+	int iRV = JSMN_ERROR_NOMEM;
+	if (xJsonGrowTokens(psPH, Need) == erSUCCESS)
+		iRV = xJsonParseTokens(psPH, psPH->szBuf);		// single pass
+	if (iRV == JSMN_ERROR_PART)
+		SL_ERR("Incomplete parsing %d tokens", psPH->NumTok);
+	jsonSTAT_HIST(Parse, T0);
 	return iRV;
 }
 
+int xJsonParseFeed(parse_hdlr_t * psPH, const char * pcBuf, size_t szCap, size_t szChunk) {
+	if (psPH->fFeed == 0) {								// first chunk of new document
+		vJsonParseReset(psPH);
+		if (psPH->MaxTok == 0)
+			psPH->fArena = 0;
+		psPH->szBuf = 0;
+		psPH->fFeed = 1;
+	}
+	IF_myASSERT(debugPARAM, psPH->szBuf == 0 || psPH->pcBuf == pcBuf);	// same buffer for all chunks
+	size_t Len = psPH->szBuf + szChunk;
+	if (Len > szCap)
+		return JSMN_ERROR_NOMEM;						// received beyond the caller buffer
+	psPH->pcBuf = pcBuf;								// chunk received in place, nothing copied
+	psPH->szBuf = Len;
+	if (szChunk) {										// primitive at the end could continue in next chunk
+		while (Len > psPH->sParser.pos && pcBuf[Len-1] && strchr("+-.0123456789Eaeflnrstu", pcBuf[Len-1]))
+			--Len;
+	}
+	if (xJsonGrowTokens(psPH, jsonEXTRA_SIZE + 1 + (szChunk / jsonBYTES_PER_TOKEN)) != erSUCCESS)
+		return JSMN_ERROR_NOMEM;
+	int iRV = xJsonParseTokens(psPH, Len);
+	return (iRV == JSMN_ERROR_PART) ? 0 : iRV;
+}
+
+u32_t xJsonHash(u32_t Hash, const char * pcKey, size_t szKey) {
+	while (szKey--)
+		Hash = (Hash ^ (u8_t) *pcKey++) * 16777619UL;
+	return Hash;
+}
+
+/**
+ * @brief	check if token is a key, ie a string (or bare primitive) with its value as only child
+ */
+static int xJsonIsKey(jsontok_t * psT) {
+	return (psT->type == JSMN_STRING || psT->type == JSMN_PRIMITIVE) && psT->size == 1 && psT->end >= psT->start;
+}
+
+int xJsonIndexBuild(parse_hdlr_t * psPH) {
+	if (psPH->NumTok < jsonINDEX_MIN_TOKENS) {
+		psPH->MaskIdx = 0;
+		return 0;
+	}
+	int NumKey = 0;
+	for (int i = 0; i < psPH->NumTok; ++i)
+		NumKey += xJsonIsKey(&psPH->psT0[i]);
+	if (psPH->fMapped && psPH->szIdx == 0 && psPH->MaskIdx)
+		return NumKey;									// mapped with the tokens, already valid
+	psPH->MaskIdx = 0;
+	int Slots = 8;
+	while (Slots < (NumKey * 2))						// load factor <= 50%
+		Slots *= 2;
+	if (Slots > psPH->szIdx) {
+		int * piNew = (int *) realloc(psPH->piIdx, Slots * sizeof(int));
+		IF_myASSERT(debugRESULT, piNew);
+		if (piNew == NULL)
+			return erFAILURE;
+		psPH->piIdx = piNew;
+		psPH->szIdx = Slots;
+	}
+	memset(psPH->piIdx, 0xFF, Slots * sizeof(int));		// all slots -1 ie empty
+	int Mask = Slots - 1;
+	for (int i = 0; i < psPH->NumTok; ++i) {
+		jsontok_t * psT = &psPH->psT0[i];
+		if (xJsonIsKey(psT) == 0)
+			continue;
+		const char * pcKey = psPH->pcBuf + psT->start;
+		size_t szKey = psT->end - psT->start;
+		int Slot = xJsonHash(jsonHASH_INIT, pcKey, szKey) & Mask;
+		while (psPH->piIdx[Slot] >= 0) {				// linear probe, first occurrence of key wins
+			jsontok_t * psK = &psPH->psT0[psPH->piIdx[Slot]];
+			if ((size_t) (psK->end - psK->start) == szKey && memcmp(psPH->pcBuf + psK->start, pcKey, szKey) == 0)
+				break;
+			Slot = (Slot + 1) & Mask;
+		}
+		if (psPH->piIdx[Slot] < 0)
+			psPH->piIdx[Slot] = i;
+	}
+	psPH->MaskIdx = Mask;
+	return NumKey;
+}
+
+/**
+ * @brief	Find a key using the hashed index
+ * @return	index of the KEY token or erFAILURE
+ */
+static int xJsonIndexFind(parse_hdlr_t * psPH, const char * pcKey, size_t szKey) {
+	int Slot = xJsonHash(jsonHASH_INIT, pcKey, szKey) & psPH->MaskIdx;
+	int Idx;
+	while ((Idx = psPH->piIdx[Slot]) >= 0) {
+		jsonSTAT_ADD(FindProbes, 1);
+		jsontok_t * psK = &psPH->psT0[Idx];
+		if ((size_t) (psK->end - psK->start) == szKey && memcmp(psPH->pcBuf + psK->start, pcKey, szKey) == 0)
+			return Idx;
+		Slot = (Slot + 1) & psPH->MaskIdx;
+	}
+	return erFAILURE;
+}
+
 /**
  * @brief	Find a specific token in the buffer
  * @return	Value > 0 (the NEXT token index) if found else erFAILURE
  */
 int xJsonFindToken(parse_hdlr_t * psPH, const char * pTok, int xKey) {
+	jsonSTAT_T0(T0);
+	jsonSTAT_ADD(FindCalls, 1);
 	size_t tokLen = strlen(pTok);
-	IF_PX(debugPARSE, "Find '%s'(%d) (%s)\r\n", pTok, tokLen, xKey ? "KEY" : "token");
+	IF_PX(debugPARSE, "Find '%s'(%d) (%s)\r\n", pTok, (int) tokLen, xKey ? "KEY" : "token");
+	if (xKey && psPH->MaskIdx) {						// key index available, no scanning required
+		int Idx = xJsonIndexFind(psPH, pTok, tokLen);
+		if (Idx >= 0) {
+			psPH->CurTok = Idx + 1;						// Index to value after "key : "
+			goto found;
+		}
+		goto notfound;
+	}
 	// Ensure we are starting at current indexed token...
 	psPH->psTx = &psPH->psT0[psPH->CurTok];
 	for (psPH->CurTok = 0; psPH->CurTok < psPH->NumTok; ++psPH->CurTok) {
@@ -162,32 +298,39 @@ int xJsonFindToken(parse_hdlr_t * psPH, const char * pTok, int xKey) {
 		// Fix to avoid crash if full object not received, ie xJsonParse 2 phase returned different results
 		if (curLen > psPH->szBuf)
 			goto next;
-		IF_PX(debugPARSE, "T#%d/%d  %d->%d=%d '%.*s'\r\n", psPH->CurTok, psPH->NumTok, psPH->psTx->start, psPH->psTx->end, psPH->psTx->end-psPH->psTx->start, curLen, psPH->pcBuf+psPH->psTx->start);
+		IF_PX(debugPARSE, "T#%d/%d  %d->%d=%d '%.*s'\r\n", psPH->CurTok, psPH->NumTok, psPH->psTx->start, psPH->psTx->end, psPH->psTx->end-psPH->psTx->start, (int) curLen, psPH->pcBuf+psPH->psTx->start);
 		// check for same length & exact content
 		if ((tokLen == curLen) &&								// check length
 			(memcmp(pTok, psPH->pcBuf + psPH->psTx->start, curLen) == 0)) {	// length OK, check content
 			if (xKey != 0) {
-				jsmntok_t * pTokNxt = (jsmntok_t*) ((void *) psPH->psTx + sizeof(jsmntok_t));
+				jsontok_t * pTokNxt = (jsontok_t*) ((void *) psPH->psTx + sizeof(jsontok_t));
 				size_t GapLen = pTokNxt->start - psPH->psTx->end;
 				// Now check if ':' present in characters between the 2 tokens...
 				void * pV = memchr(psPH->pcBuf+psPH->psTx->end, CHR_COLON, GapLen);
-				IF_PX(debugPARSE, " %p `%.*s`", pV, GapLen, psPH->pcBuf+psPH->psTx->end);
+				IF_PX(debugPARSE, " %p `%.*s`", pV, (int) GapLen, psPH->pcBuf+psPH->psTx->end);
 				if (pV == NULL) {
 					IF_PX(debugPARSE, " %d=not KEY", psPH->CurTok);
 					goto next;
 				}
 			}
 			IF_PX(debugPARSE, " [Found]" strNL);
+			jsonSTAT_ADD(FindProbes, psPH->CurTok + 1);
 			++psPH->CurTok;								// Index to value after "key : "
-			psPH->psTx = &psPH->psT0[psPH->CurTok];		// and set pointer the same...
-			return psPH->CurTok;
+			goto found;
 		}
 next:
 	}
+	jsonSTAT_ADD(FindProbes, psPH->NumTok);
+notfound:
 	IF_PX(debugPARSE, " [NOT FOUND]" strNL);
 	psPH->CurTok = 0;
 	psPH->psTx = NULL;
+	jsonSTAT_HIST(Find, T0);
 	return erFAILURE;
+found:
+	psPH->psTx = &psPH->psT0[psPH->CurTok];				// and set pointer the same...
+	jsonSTAT_HIST(Find, T0);
+	return psPH->CurTok;
 }
 
 int xJsonFindKeyValue(parse_hdlr_t * psPH, const char * pK, const char * pV) {
@@ -211,23 +354,193 @@ int xJsonFindKeyValue(parse_hdlr_t * psPH, const char * pK, const char * pV) {
 }
 
 /**
- * @brief	Primarily used by HTTP requests to parse response values to variable locations
- * @return	0 if token not found or error parsing else 1
+ * @brief	decode 4 hex digits
+ * @return	erSUCCESS or erFAILURE if not 4 hex digits
  */
-int xJsonParseEntry(parse_hdlr_t * psPH, ph_entry_t * psEntry) {
-	IF_PX(debugPARSE, "[%s/%s] ", pcIndex2String(psEntry->cvI), psEntry->pcKey);
-	int iRV = xJsonFindToken(psPH, psEntry->pcKey, 1);
-	if (iRV <= erSUCCESS)
-		return 0;
-	// if successful, structure members already updates for token found...
+static int xJsonHex4(const char * pcSrc, size_t szSrc, u32_t * pU32) {
+	if (szSrc < 4)
+		return erFAILURE;
+	u32_t U32 = 0;
+	for (int i = 0; i < 4; ++i) {
+		u8_t cChr = pcSrc[i];
+		int Nib = (cChr >= '0' && cChr <= '9') ? cChr - '0' : ((cChr | 0x20) >= 'a' && (cChr | 0x20) <= 'f') ? (cChr | 0x20) - 'a' + 10 : -1;
+		if (Nib < 0)
+			return erFAILURE;
+		U32 = (U32 << 4) | Nib;
+	}
+	*pU32 = U32;
+	return erSUCCESS;
+}
+
+static int xJsonEncodeUTF8(char * pcBuf, u32_t CP) {
+	if (CP < 0x80) {
+		pcBuf[0] = CP;
+		return 1;
+	}
+	if (CP < 0x800) {
+		pcBuf[0] = 0xC0 | (CP >> 6);
+		pcBuf[1] = 0x80 | (CP & 0x3F);
+		return 2;
+	}
+	if (CP < 0x10000) {
+		pcBuf[0] = 0xE0 | (CP >> 12);
+		pcBuf[1] = 0x80 | ((CP >> 6) & 0x3F);
+		pcBuf[2] = 0x80 | (CP & 0x3F);
+		return 3;
+	}
+	pcBuf[0] = 0xF0 | (CP >> 18);
+	pcBuf[1] = 0x80 | ((CP >> 12) & 0x3F);
+	pcBuf[2] = 0x80 | ((CP >> 6) & 0x3F);
+	pcBuf[3] = 0x80 | (CP & 0x3F);
+	return 4;
+}
+
+/**
+ * @brief	decode the escapes of a string span, UTF-8 output
+ * @param	pcDst - output, may be the same as pcSrc (never written ahead of the input), NULL to only validate
+ * @param	szDst - size of pcDst, output truncated on a UTF-8 character boundary to fit with NUL
+ * @return	decoded length (excl NUL) or erFAILURE if an escape is invalid
+ */
+static int xJsonUnescape(char * pcDst, size_t szDst, const char * pcSrc, size_t szSrc) {
+	size_t Len = 0, Idx = 0;
+	while (Idx < szSrc) {
+		char caU8[4];
+		const char * pcUnit = pcSrc + Idx;
+		size_t szUnit;
+		u8_t cChr = pcSrc[Idx];
+		if (cChr != CHR_BACKSLASH) {					// copy complete UTF-8 sequence as is
+			szUnit = (cChr < 0xC0) ? 1 : (cChr < 0xE0) ? 2 : (cChr < 0xF0) ? 3 : 4;
+			if (szUnit > (szSrc - Idx))
+				szUnit = szSrc - Idx;
+			Idx += szUnit;
+		} else {
+			if ((Idx + 1) == szSrc)
+				return erFAILURE;
+			cChr = pcSrc[Idx + 1];
+			Idx += 2;
+			u32_t CP, Lo;
+			switch (cChr) {
+			case CHR_DOUBLE_QUOTE:
+			case CHR_BACKSLASH:
+			case '/': CP = cChr; break;
+			case 'b': CP = '\b'; break;
+			case 'f': CP = '\f'; break;
+			case 'n': CP = '\n'; break;
+			case 'r': CP = '\r'; break;
+			case 't': CP = '\t'; break;
+			case 'u':
+				if (xJsonHex4(pcSrc + Idx, szSrc - Idx, &CP) != erSUCCESS)
+					return erFAILURE;
+				Idx += 4;
+				if (CP >= 0xD800 && CP <= 0xDBFF) {		// high surrogate, MUST be followed by low surrogate
+					if ((szSrc - Idx) >= 6 && pcSrc[Idx] == CHR_BACKSLASH && pcSrc[Idx + 1] == 'u' &&
+						xJsonHex4(pcSrc + Idx + 2, 4, &Lo) == erSUCCESS && Lo >= 0xDC00 && Lo <= 0xDFFF) {
+						CP = 0x10000 + ((CP - 0xD800) << 10) + (Lo - 0xDC00);
+						Idx += 6;
+					} else {
+						CP = 0xFFFD;
+					}
+				} else if (CP >= 0xDC00 && CP <= 0xDFFF) {
+					CP = 0xFFFD;						// lone low surrogate
+				} else if (CP == 0) {
+					return erFAILURE;					// embedded NUL not representable
+				}
+				break;
+			default: return erFAILURE;
+			}
+			szUnit = xJsonEncodeUTF8(caU8, CP);
+			pcUnit = caU8;
+		}
+		if (pcDst) {
+			if ((Len + szUnit) >= szDst)
+				break;									// truncate, keep space for NUL
+			memmove(pcDst + Len, pcUnit, szUnit);
+		}
+		Len += szUnit;
+	}
+	if (pcDst)
+		pcDst[Len] = CHR_NUL;
+	return Len;
+}
+
+/**
+ * @brief	check if a string token has been decoded in place by xJsonStringView()
+ */
+static int xJsonIsDecoded(parse_hdlr_t * psPH, int Tok) {
+	return (Tok >> 5) < psPH->szDec && (psPH->puDec[Tok >> 5] & (1U << (Tok & 31)));
+}
+
+int xJsonStringView(parse_hdlr_t * psPH, int Tok, json_str_t * psStr) {
+	if (Tok < 0 || Tok >= psPH->NumTok || psPH->psT0[Tok].type != JSMN_STRING)
+		return erFAILURE;
+	jsontok_t * psT = &psPH->psT0[Tok];
+	char * pcSrc = (char *) psPH->pcBuf + psT->start;
+	size_t szSrc = psT->end - psT->start;
+	psStr->pcStr = pcSrc;
+	psStr->szStr = szSrc;
+	if (xJsonIsDecoded(psPH, Tok) || memchr(pcSrc, CHR_BACKSLASH, szSrc) == NULL)
+		return erSUCCESS;								// decoded by a previous call or no escapes, as is
+	if (xJsonUnescape(NULL, 0, pcSrc, szSrc) < erSUCCESS)
+		return erFAILURE;								// validate first, source left untouched
+	int szDec = (psPH->NumTok + 31) >> 5;
+	if (szDec > psPH->szDec) {
+		u32_t * puNew = (u32_t *) realloc(psPH->puDec, szDec * sizeof(u32_t));
+		IF_myASSERT(debugRESULT, puNew);
+		if (puNew == NULL)
+			return erFAILURE;
+		memset(puNew + psPH->szDec, 0, (szDec - psPH->szDec) * sizeof(u32_t));
+		psPH->puDec = puNew;
+		psPH->szDec = szDec;
+	}
+	int Len = xJsonUnescape(pcSrc, szSrc, pcSrc, szSrc);	// always shorter, fits with NUL
+	size_t Skip = szSrc - Len;
+	memmove(pcSrc + Skip, pcSrc, Len);					// end aligned, gap to the next token unchanged
+	psT->start += Skip;
+	psPH->puDec[Tok >> 5] |= (1U << (Tok & 31));
+	if (psPH->MaskIdx && xJsonIsKey(psT)) {				// hashed as escaped, revert to scanning
+		psPH->MaskIdx = 0;
+		if (psPH->szIdx == 0)
+			psPH->piIdx = NULL;							// mapped, not ours
+	}
+	psStr->pcStr = pcSrc + Skip;
+	psStr->szStr = Len;
+	return erSUCCESS;
+}
+
+int xJsonStringCopy(parse_hdlr_t * psPH, int Tok, char * pcDst, size_t szDst) {
+	if (szDst == 0 || Tok < 0 || Tok >= psPH->NumTok || psPH->psT0[Tok].type != JSMN_STRING)
+		return erFAILURE;
+	const char * pcSrc = psPH->pcBuf + psPH->psT0[Tok].start;
+	size_t szSrc = psPH->psT0[Tok].end - psPH->psT0[Tok].start;
+	if (xJsonIsDecoded(psPH, Tok) == 0)
+		return xJsonUnescape(pcDst, szDst, pcSrc, szSrc);
+	size_t Len = (szSrc < szDst) ? szSrc : szDst - 1;	// decoded in place already, copy as is
+	if (Len < szSrc) {
+		while (Len && ((u8_t) pcSrc[Len] & 0xC0) == 0x80)
+			--Len;										// back up to start of split character
+	}
+	memcpy(pcDst, pcSrc, Len);
+	pcDst[Len] = CHR_NUL;
+	return Len;
+}
+
+/**
+ * @brief	Decode the value at the current token (psTx) into the entry variable
+ * @return	0 if error parsing else 1
+ */
+static int xJsonParseValue(parse_hdlr_t * psPH, ph_entry_t * psEntry) {
 	IF_EXEC_2(debugPARSE, xJsonPrintToken, NULL, psPH);
 	char * pSrc = (char *) psPH->pcBuf + psPH->psTx->start;
 	if (psEntry->pxVar.pv != NULL) {
-		if (psEntry->cvI == cvSXX) {
+		if (psEntry->cvI == cvSXX) {					// escapes decoded, bounded if size supplied
 			IF_myASSERT(debugTRACK, psPH->psTx->type == JSMN_STRING);
-			size_t szV = psPH->psTx->end - psPH->psTx->start;				// calculate length
-			strncpy(psEntry->pxVar.pc8, pSrc, szV);			// strncpy with exact size,
-			*(psEntry->pxVar.pc8 + szV) = CHR_NUL;			// terminate
+			size_t szV = psEntry->szVar ? psEntry->szVar : (size_t) (psPH->psTx->end - psPH->psTx->start) + 1;
+			if (xJsonStringCopy(psPH, psPH->psTx - psPH->psT0, psEntry->pxVar.pc8, szV) < erSUCCESS)
+				return 0;
+		} else if (psEntry->cvI <= cvF64) {				// numbers parsed from exact token span
+			IF_myASSERT(debugTRACK, psPH->psTx->type == JSMN_PRIMITIVE);
+			if (xJsonParseNumber(pSrc, psPH->psTx->end - psPH->psTx->start, psEntry->pxVar, psEntry->cvI) != erSUCCESS)
+				return 0;
 		} else {
 			IF_myASSERT(debugTRACK, psPH->psTx->type == JSMN_PRIMITIVE);
 			if (cvParseValue(pSrc, psEntry->cvI, psEntry->pxVar) == pcFAILURE) {
@@ -237,3 +550,373 @@ int xJsonParseEntry(parse_hdlr_t * psPH, ph_entry_t * psEntry) {
 	}
 	return 1;
 }
+
+/**
+ * @brief	Primarily used by HTTP requests to parse response values to variable locations
+ * @return	0 if token not found or error parsing else 1
+ */
+int xJsonParseEntry(parse_hdlr_t * psPH, ph_entry_t * psEntry) {
+	IF_PX(debugPARSE, "[%s/%s] ", pcIndex2String(psEntry->cvI), psEntry->pcKey);
+	int iRV = xJsonFindToken(psPH, psEntry->pcKey, 1);
+	if (iRV <= erSUCCESS)
+		return 0;
+	// if successful, structure members already updates for token found...
+	return xJsonParseValue(psPH, psEntry);
+}
+
+int xJsonEntriesBuild(ph_entries_t * psEntries) {
+	if (__atomic_load_n(&psEntries->psKeys, __ATOMIC_ACQUIRE) || psEntries->Count == 0)
+		return erSUCCESS;
+	int NumWalk = (psEntries->Count + jsonENTRIES_WALK - 1) / jsonENTRIES_WALK;
+	ph_keys_t * psKeys = (ph_keys_t *) calloc(NumWalk, sizeof(ph_keys_t));
+	if (psKeys == NULL)
+		return erFAILURE;
+	for (int w = 0; w < NumWalk; ++w) {
+		ph_keys_t * psK = &psKeys[w];
+		ph_entry_t * psEntry = &psEntries->Entry[w * jsonENTRIES_WALK];
+		int Count = psEntries->Count - (w * jsonENTRIES_WALK);
+		if (Count > jsonENTRIES_WALK)
+			Count = jsonENTRIES_WALK;
+		int Slots = 8;
+		while (Slots < (Count * 2))
+			Slots *= 2;
+		psK->Mask = Slots - 1;
+		for (int e = 0; e < Count; ++e) {
+			psK->szKey[e] = strlen(psEntry[e].pcKey);
+			int Slot = xJsonHash(jsonHASH_INIT, psEntry[e].pcKey, psK->szKey[e]) & psK->Mask;
+			while (psK->Map[Slot])
+				Slot = (Slot + 1) & psK->Mask;
+			psK->Map[Slot] = e + 1;
+		}
+	}
+	ph_keys_t * psNone = NULL;							// first complete build wins, others discarded
+	if (__atomic_compare_exchange_n(&psEntries->psKeys, &psNone, psKeys, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) == 0)
+		free(psKeys);
+	return erSUCCESS;
+}
+
+void vJsonEntriesRelease(ph_entries_t * psEntries) {
+	free(psEntries->psKeys);
+	psEntries->psKeys = NULL;
+}
+
+/**
+ * @brief	Single walk through all tokens, decode up to jsonENTRIES_WALK keys at their first occurrence
+ * @return	bitmap of entries found and parsed
+ */
+static u64_t xJsonParseEntriesWalk(parse_hdlr_t * psPH, const ph_keys_t * psK, ph_entry_t * psEntry, int Count) {
+	u64_t Found = 0, Seen = 0;
+	u64_t All = (Count < 64) ? (1ULL << Count) - 1 : ~0ULL;
+	for (int i = 0; (i < psPH->NumTok) && (Seen != All); ++i) {
+		jsontok_t * psT = &psPH->psT0[i];
+		if (xJsonIsKey(psT) == 0)
+			continue;
+		const char * pcTok = psPH->pcBuf + psT->start;
+		size_t szTok = psT->end - psT->start;
+		for (int Slot = xJsonHash(jsonHASH_INIT, pcTok, szTok) & psK->Mask; psK->Map[Slot]; Slot = (Slot + 1) & psK->Mask) {
+			int e = psK->Map[Slot] - 1;
+			if (psK->szKey[e] != szTok || memcmp(psEntry[e].pcKey, pcTok, szTok) != 0)
+				continue;
+			if ((Seen & (1ULL << e)) == 0) {
+				Seen |= 1ULL << e;
+				psPH->CurTok = i + 1;					// value after "key : "
+				psPH->psTx = &psPH->psT0[psPH->CurTok];
+				if (xJsonParseValue(psPH, &psEntry[e]))
+					Found |= 1ULL << e;
+			}
+			// duplicate keys in table all decoded from the same value, continue probing
+		}
+	}
+	return Found;
+}
+
+u64_t xJsonParseEntries(parse_hdlr_t * psPH, ph_entries_t * psEntries) {
+	u64_t Found = 0;
+	if (psPH->MaskIdx) {								// key index available, K lookups cheaper than a walk
+		for (int e = 0; e < psEntries->Count; ++e) {
+			if (xJsonParseEntry(psPH, &psEntries->Entry[e]) && e < 64)
+				Found |= 1ULL << e;
+		}
+	} else if (xJsonEntriesBuild(psEntries) == erSUCCESS) {
+		ph_keys_t * psKeys = __atomic_load_n(&psEntries->psKeys, __ATOMIC_ACQUIRE);
+		for (int e = 0; e < psEntries->Count; e += jsonENTRIES_WALK) {	// bounded state, 1 walk per 64 entries
+			int Num = (psEntries->Count - e < jsonENTRIES_WALK) ? psEntries->Count - e : jsonENTRIES_WALK;
+			u64_t Walk = xJsonParseEntriesWalk(psPH, &psKeys[e / jsonENTRIES_WALK], &psEntries->Entry[e], Num);
+			if (e == 0)
+				Found = Walk;							// only the first 64 reported
+		}
+	}
+	psPH->CurTok = 0;
+	psPH->psTx = NULL;
+	return Found;
+}
+
+int xJsonSkipBuild(parse_hdlr_t * psPH) {
+	int NumTok = psPH->NumTok;
+	if (NumTok > psPH->szNext) {
+		int * piNew = (int *) realloc(psPH->piNext, NumTok * sizeof(int));
+		IF_myASSERT(debugRESULT, piNew);
+		if (piNew == NULL)
+			return erFAILURE;
+		psPH->piNext = piNew;
+		psPH->szNext = NumTok;
+	}
+	// Reverse walk, children already resolved so each child is stepped over exactly once
+	for (int i = NumTok - 1; i >= 0; --i) {
+		int j = i + 1;
+		for (int c = psPH->psT0[i].size; c > 0 && j < NumTok; --c)
+			j = psPH->piNext[j];
+		psPH->piNext[i] = j;
+	}
+	psPH->NumNext = NumTok;
+	return NumTok;
+}
+
+/**
+ * @brief	compare JSON Pointer path segment (with ~0 & ~1 escapes) to a key token
+ */
+static int xJsonPathMatch(const char * pcSeg, size_t szSeg, const char * pcKey, size_t szKey) {
+	while (szSeg && szKey) {
+		char cChr = *pcSeg++;
+		--szSeg;
+		if (cChr == '~' && szSeg) {
+			cChr = (*pcSeg == '0') ? '~' : (*pcSeg == '1') ? '/' : CHR_NUL;
+			++pcSeg;
+			--szSeg;
+		}
+		if (cChr != *pcKey++)
+			return 0;
+		--szKey;
+	}
+	return (szSeg == 0) && (szKey == 0);
+}
+
+int xJsonFindPath(parse_hdlr_t * psPH, const char * pcPath) {
+	if (psPH->NumNext != psPH->NumTok && xJsonSkipBuild(psPH) < erSUCCESS)
+		return erFAILURE;
+	int Tok = 0;
+	while (Tok < psPH->NumTok && *pcPath == '/') {
+		const char * pcSeg = ++pcPath;
+		while (*pcPath && *pcPath != '/')
+			++pcPath;
+		size_t szSeg = pcPath - pcSeg;
+		jsontok_t * psT = &psPH->psT0[Tok];
+		int Child = Tok + 1, Count = psT->size;
+		IF_PX(debugPARSE, "Path '%.*s' T#%d" strNL, (int) szSeg, pcSeg, Tok);
+		if (psT->type == JSMN_OBJECT) {
+			for (; Count; --Count, Child = psPH->piNext[Child]) {
+				jsontok_t * psK = &psPH->psT0[Child];
+				if (xJsonPathMatch(pcSeg, szSeg, psPH->pcBuf + psK->start, psK->end - psK->start))
+					break;
+			}
+			++Child;									// key -> value
+		} else if (psT->type == JSMN_ARRAY) {
+			int Idx = 0;
+			if (szSeg == 0 || szSeg > 9 || (*pcSeg == '0' && szSeg > 1))
+				goto notfound;
+			for (size_t x = 0; x < szSeg; ++x) {
+				if (INRANGE('0', pcSeg[x], '9') == 0)
+					goto notfound;
+				Idx = (Idx * 10) + pcSeg[x] - '0';
+			}
+			if (Idx >= Count)
+				goto notfound;
+			for (; Idx; --Idx)
+				Child = psPH->piNext[Child];
+		} else {
+			goto notfound;
+		}
+		if (Count == 0 || Child >= psPH->NumTok)
+			goto notfound;
+		Tok = Child;
+	}
+	if (*pcPath || Tok >= psPH->NumTok)
+		goto notfound;
+	psPH->CurTok = Tok;
+	psPH->psTx = &psPH->psT0[Tok];
+	return Tok;
+notfound:
+	psPH->CurTok = 0;
+	psPH->psTx = NULL;
+	return erFAILURE;
+}
+
+int xJsonParent(parse_hdlr_t * psPH, int Tok) {
+	if (Tok <= 0 || Tok >= psPH->NumTok)
+		return erFAILURE;
+	#if (jsonTOKEN_COMPACT == 1 && jsonTOKEN_PARENT == 1)
+	return (psPH->psT0[Tok].parent == jsonTOK_UNSET) ? erFAILURE : psPH->psT0[Tok].parent;
+	#elif (jsonTOKEN_COMPACT == 0 && defined(JSMN_PARENT_LINKS))
+	return (psPH->psT0[Tok].parent < 0) ? erFAILURE : psPH->psT0[Tok].parent;
+	#else
+	if (psPH->NumNext != psPH->NumTok && xJsonSkipBuild(psPH) < erSUCCESS)
+		return erFAILURE;
+	for (int i = Tok - 1; i >= 0; --i) {				// nearest preceding token whose subtree covers Tok
+		if (psPH->piNext[i] > Tok)
+			return i;
+	}
+	return erFAILURE;
+	#endif
+}
+
+// ##################################### re-emit tokens as JSON ####################################
+
+typedef struct json_emit_t {
+	ubuf_t * psUB;										// destination, NULL if measuring
+	size_t Count;										// bytes (to be) written
+	int fFull;											// output truncated
+	report_t * psR;										// if set, psUB is flushed here when full
+	int Base;											// indent levels added to all lines
+} json_emit_t;
+
+/**
+ * @brief	report & empty the (bounded) emit buffer
+ */
+static void vJsonEmitFlush(json_emit_t * psE) {
+	if (xUBufGetUsed(psE->psUB))
+		xReport(psE->psR, "%.*s", xUBufGetUsed(psE->psUB), psE->psUB->pBuf);
+	vUBufReset(psE->psUB);
+}
+
+static void vJsonEmitWrite(json_emit_t * psE, const char * pcBuf, size_t szBuf) {
+	psE->Count += szBuf;
+	if (psE->psUB == NULL)
+		return;
+	size_t szSpace = xUBufGetSpace(psE->psUB);
+	if (szBuf > szSpace && psE->psR) {					// reporting, flush first, report long spans directly
+		vJsonEmitFlush(psE);
+		szSpace = xUBufGetSpace(psE->psUB);
+		if (szBuf > szSpace) {
+			xReport(psE->psR, "%.*s", (int) szBuf, pcBuf);
+			return;
+		}
+	}
+	if (szBuf > szSpace) {
+		szBuf = szSpace;
+		psE->fFull = 1;
+	}
+	memcpy(pcUBufTellWrite(psE->psUB), pcBuf, szBuf);
+	vUBufStepWrite(psE->psUB, szBuf);
+}
+
+/**
+ * @brief	optional separator, then new line and indent to Depth, 32 spaces per copy
+ */
+static void vJsonEmitIndent(json_emit_t * psE, char cSep, int Indent, int Depth) {
+	static const char caIndent[] = ",\n                                ";
+	size_t szPad = Indent * (psE->Base + Depth);
+	size_t szNow = (szPad < 32) ? szPad : 32;
+	if (cSep)
+		vJsonEmitWrite(psE, caIndent, 2 + szNow);
+	else
+		vJsonEmitWrite(psE, caIndent + 1, 1 + szNow);
+	for (szPad -= szNow; szPad; szPad -= szNow) {
+		szNow = (szPad < 32) ? szPad : 32;
+		vJsonEmitWrite(psE, caIndent + 2, szNow);
+	}
+}
+
+/**
+ * @brief	quoted string decoded in place by xJsonStringView(), escaped again
+ */
+static void vJsonEmitString(json_emit_t * psE, const char * pcStr, size_t szStr) {
+	vJsonEmitWrite(psE, "\"", 1);
+	while (szStr) {
+		size_t szRun = 0;								// copy run of characters not requiring escapes
+		while (szRun < szStr && (u8_t) pcStr[szRun] >= 0x20 && pcStr[szRun] != CHR_DOUBLE_QUOTE && pcStr[szRun] != CHR_BACKSLASH)
+			++szRun;
+		vJsonEmitWrite(psE, pcStr, szRun);
+		if (szRun == szStr)
+			break;
+		u8_t cChr = pcStr[szRun];
+		char caEsc[6] = { CHR_BACKSLASH, cChr, '0', '0', "0123456789ABCDEF"[cChr >> 4], "0123456789ABCDEF"[cChr & 0xF] };
+		switch (cChr) {
+		case '\b': caEsc[1] = 'b'; break;
+		case '\f': caEsc[1] = 'f'; break;
+		case '\n': caEsc[1] = 'n'; break;
+		case '\r': caEsc[1] = 'r'; break;
+		case '\t': caEsc[1] = 't'; break;
+		case CHR_DOUBLE_QUOTE:
+		case CHR_BACKSLASH: break;
+		default: caEsc[1] = 'u'; break;					// other control characters as \u00XX
+		}
+		vJsonEmitWrite(psE, caEsc, (caEsc[1] == 'u') ? 6 : 2);
+		pcStr += szRun + 1;
+		szStr -= szRun + 1;
+	}
+	vJsonEmitWrite(psE, "\"", 1);
+}
+
+/**
+ * @brief	emit the value at Tok, see xJsonEmit()
+ */
+static int xJsonEmitValue(parse_hdlr_t * psPH, int Tok, json_emit_t * psE, int Indent) {
+	if (Tok < 0 || Tok >= psPH->NumTok)
+		return erFAILURE;
+	struct { int Done, Num; } sLevel[jsonEMIT_MAX_DEPTH];	// items done/total per open container, key & value = 2 items
+	u8_t Stack[jsonEMIT_MAX_DEPTH / 8];					// nesting bit stack, 1 = object
+	int Depth = 0;
+	do {
+		if (Tok >= psPH->NumTok)						// container incomplete
+			return erFAILURE;
+		jsontok_t * psT = &psPH->psT0[Tok++];
+		if (Depth) {									// separator & indent, or key/value delimiter
+			int Done = sLevel[Depth-1].Done;
+			if ((Stack[(Depth-1) >> 3] & (1 << ((Depth-1) & 7))) && (Done & 1)) {
+				vJsonEmitWrite(psE, ": ", Indent ? 2 : 1);
+			} else if (Indent) {
+				vJsonEmitIndent(psE, Done ? CHR_COMMA : 0, Indent, Depth);
+			} else if (Done) {
+				vJsonEmitWrite(psE, ",", 1);
+			}
+		}
+		if (psT->type == JSMN_OBJECT || psT->type == JSMN_ARRAY) {
+			int fObj = (psT->type == JSMN_OBJECT);
+			vJsonEmitWrite(psE, fObj ? "{}" : "[]", psT->size ? 1 : 2);
+			if (psT->size) {
+				if (Depth == jsonEMIT_MAX_DEPTH)
+					return erFAILURE;
+				if (fObj)
+					Stack[Depth >> 3] |= (1 << (Depth & 7));
+				else
+					Stack[Depth >> 3] &= ~(1 << (Depth & 7));
+				sLevel[Depth].Done = 0;
+				sLevel[Depth].Num = fObj ? (psT->size * 2) : psT->size;
+				++Depth;
+				continue;								// children follow
+			}
+		} else if (psT->type == JSMN_STRING) {
+			if (xJsonIsDecoded(psPH, Tok - 1))
+				vJsonEmitString(psE, psPH->pcBuf + psT->start, psT->end - psT->start);
+			else										// include the quotes
+				vJsonEmitWrite(psE, psPH->pcBuf + psT->start - 1, psT->end - psT->start + 2);
+		} else {
+			vJsonEmitWrite(psE, psPH->pcBuf + psT->start, psT->end - psT->start);
+		}
+		// item complete, close all containers completed by it
+		while (Depth && ++sLevel[Depth-1].Done == sLevel[Depth-1].Num) {
+			--Depth;
+			char cClose = (Stack[Depth >> 3] & (1 << (Depth & 7))) ? CHR_R_CURLY : CHR_R_SQUARE;
+			if (Indent)
+				vJsonEmitIndent(psE, 0, Indent, Depth);
+			vJsonEmitWrite(psE, &cClose, 1);
+		}
+	} while (Depth);
+	return psE->fFull ? erJSON_BUF_FULL : (int) psE->Count;
+}
+
+int xJsonEmit(parse_hdlr_t * psPH, int Tok, ubuf_t * psUB, int Indent) {
+	json_emit_t sE = { .psUB = psUB };
+	return xJsonEmitValue(psPH, Tok, &sE, Indent);
+}
+
+int xJsonReportTokens(parse_hdlr_t * psPH, int Depth) {
+	report_t sRprt = { .sFM.u32Val = makeMASK08_3x8(0,0,0,0,0,0,0,0,2,0,0) };
+	char caBuf[jsonREPORT_BUF_SIZE];
+	ubuf_t sUB = { .pBuf = caBuf, .Size = sizeof(caBuf) };
+	json_emit_t sE = { .psUB = &sUB, .psR = &sRprt, .Base = Depth };
+	int iRV = xJsonEmitValue(psPH, 0, &sE, 2);
+	vJsonEmitFlush(&sE);
+	xReport(&sRprt, strNL);
+	return iRV;
+}
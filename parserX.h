@@ -2,15 +2,23 @@
 
 #pragma once
 
-#define JSMN_HEADER
-#include "jsmn.h"
+#include "tokenX.h"
 #include "database.h"
+#include "x_ubuf.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 // ########################################## macros ###############################################
+
+#define	jsonEXTRA_SIZE				5					// spare (zeroed) tokens beyond last parsed token
+#define	jsonBYTES_PER_TOKEN			16					// initial arena sizing estimate, source bytes per token
+#define	jsonMIN_TOKENS				16					// smallest arena allocated
+#define	jsonINDEX_MIN_TOKENS		64					// smaller documents are searched linearly
+#define	jsonHASH_INIT				2166136261UL		// FNV-1a offset basis, default key hash seed
+#define	jsonEMIT_MAX_DEPTH			64					// object/array nesting levels re-emitted
+#define	jsonENTRIES_WALK			64					// table entries matched per walk, u64 masks
 // ######################################## enumerations ###########################################
 // ############################################ structures #########################################
 
@@ -18,10 +26,28 @@ typedef struct {
 	const char * pcBuf;										// JSON source buffer
 	size_t szBuf;										// source buffer size
 	jsmn_parser sParser;								// control structure
-	jsmntok_t *	psT0;									// jsmntok_t array allocated memory
-	jsmntok_t *	psTx;									// Current token being processed
+	jsontok_t *	psT0;									// jsontok_t array, caller pool or allocated arena
+	jsontok_t *	psTx;									// Current token being processed
 	int NumTok;											// number of tokens parsed
 	int CurTok;											// index of current token being processed
+	int MaxTok;											// capacity of psT0 incl spare, 0 if none yet
+	int * piIdx;										// key index, open addressed hash of key token #s
+	int szIdx;											// number of slots allocated for piIdx
+	int MaskIdx;										// slot mask of current index, 0 if not built
+	int * piNext;										// per token, index of next sibling (end of subtree)
+	int szNext;											// number of entries allocated for piNext
+	int NumNext;										// number of entries valid in piNext, 0 if not built
+	u32_t * puDec;										// per token, bit set if string decoded in place
+	int szDec;											// number of words allocated for puDec
+	union {
+		struct {
+			u8_t fArena:1;								// psT0 allocated here, freed by vJsonParseRelease()
+			u8_t fIndex:1;								// build key index after each xJsonParse()
+			u8_t fFeed:1;								// xJsonParseFeed() in progress, pcBuf is the caller receive buffer
+			u8_t fMapped:1;								// psT0 (and piIdx if szIdx 0) in a file mapping, see cacheX.h
+		};
+		u8_t Flags;
+	};
 	void * pvArg;
 } parse_hdlr_t;
 
@@ -34,21 +60,167 @@ typedef struct ph_entry_t {
 	const char * pcKey;
 	px_t pxVar;
 	cvi_e cvI;
+	size_t szVar;										// cvSXX buffer size, 0 = sized for the raw string
 } ph_entry_t;
 
+typedef struct json_str_t {								// string view, NOT NUL terminated
+	const char * pcStr;
+	size_t szStr;
+} json_str_t;
+
+typedef struct ph_keys_t {								// hashed key set of jsonENTRIES_WALK table entries
+	int Mask;											// slots - 1, power of 2
+	u8_t Map[jsonENTRIES_WALK * 2];						// slot -> entry# + 1, 0 is empty, load factor <= 50%
+	u32_t szKey[jsonENTRIES_WALK];						// key lengths, computed once
+} ph_keys_t;
+
 typedef struct ph_entries_t {
 	u8_t Count;
+	ph_keys_t * psKeys;									// 1 per jsonENTRIES_WALK entries, built on first walk
 	ph_entry_t Entry[];
 } ph_entries_t;
 
 // ####################################### global functions ########################################
 
+/**
+ * @brief	Attach a caller supplied token pool (or none) to a parse handler
+ * @param	psPH - parse handler to initialise, pcBuf & szBuf untouched
+ * @param	psPool - token pool to use, NULL to let parser allocate & grow an arena
+ * @param	MaxTok - number of tokens in psPool
+ * @note	If the pool overflows it is copied to an allocated arena, the pool itself is never freed
+ */
+void vJsonParseInit(parse_hdlr_t * psPH, jsontok_t * psPool, int MaxTok);
+
+/**
+ * @brief	Discard the current document but retain token memory for the next xJsonParse()
+ */
+void vJsonParseReset(parse_hdlr_t * psPH);
+
+/**
+ * @brief	Free the token arena (if allocated by the parser) and reset the handler
+ */
+void vJsonParseRelease(parse_hdlr_t * psPH);
+
+/**
+ * @brief	Tokenise pcBuf/szBuf in a single pass, growing the token arena only on overflow
+ * @return	number of tokens parsed, 0 or less if error
+ * @note	Token memory is retained across calls, release with vJsonParseRelease()
+ */
 int xJsonParse(parse_hdlr_t * psPH);
+
+/**
+ * @brief	Resumable parse, the document is received in chunks directly into a caller buffer
+ * @param	pcBuf - caller receive buffer, the same for all chunks of a document
+ * @param	szCap - capacity of pcBuf
+ * @param	szChunk - bytes just received at pcBuf + psPH->szBuf, 0 to indicate end of input
+ *			(completes a bare top level primitive)
+ * @return	number of tokens if top level value complete, 0 if more data required, < 0 if error,
+ *			JSMN_ERROR_NOMEM if the document exceeds szCap or the tokens cannot grow
+ * @note	Nothing is copied, only psPH->szBuf advances. Receive the first chunk at pcBuf, the
+ *			next at pcBuf + szBuf, at most szCap - szBuf bytes. Tokens are added incrementally without rescanning earlier
+ *			chunks, but they refer to the source by offset: the whole document is retained in pcBuf
+ *			for the life of the tokens, so peak memory is the document plus the tokens.
+ *			vJsonParseReset() before the next document.
+ */
+int xJsonParseFeed(parse_hdlr_t * psPH, const char * pcBuf, size_t szCap, size_t szChunk);
+
+/**
+ * @brief	FNV-1a hash of a key
+ * @param	Hash - seed, jsonHASH_INIT for the standard hash
+ */
+u32_t xJsonHash(u32_t Hash, const char * pcKey, size_t szKey);
+
+/**
+ * @brief	Build hashed index of all key tokens, used by xJsonFindToken() for key lookups
+ * @return	number of keys indexed, 0 if document too small (linear search used) or erFAILURE
+ * @note	Built automatically by xJsonParse() if fIndex set, duplicate keys resolve to the first
+ */
+int xJsonIndexBuild(parse_hdlr_t * psPH);
 int xJsonFindToken(parse_hdlr_t * psPH, const char * pKey, int Key);
 int xJsonFindKeyValue(parse_hdlr_t * psPH, const char * pK, const char * pV);
 int xJsonFindKeyValue(parse_hdlr_t * psPH, const char * pK, const char * pV);
 int xJsonParseEntry(parse_hdlr_t * psPH, ph_entry_t * psEntry);
 
+/**
+ * @brief	Obtain a view of a string token, escapes (if any) decoded in place to UTF-8
+ * @param	Tok - index of string token
+ * @return	erSUCCESS or erFAILURE if not a string or invalid escape
+ * @note	Strings with escapes are decoded into the tail of their own span, hence the source MUST be
+ *			writable. Token start is moved to the decoded text and the token marked decoded, later
+ *			calls, xJsonFindToken() and xJsonEmit() then use the decoded text.
+ *			Lone surrogates decode to U+FFFD, \u0000 is rejected.
+ */
+int xJsonStringView(parse_hdlr_t * psPH, int Tok, json_str_t * psStr);
+
+/**
+ * @brief	Copy a string token, escapes decoded to UTF-8, source not modified
+ * @param	szDst - size of pcDst, output truncated on a UTF-8 character boundary and always NUL terminated
+ * @return	number of characters copied (excl NUL) or erFAILURE if not a string, invalid escape,
+ *			\u0000 or szDst is 0
+ */
+int xJsonStringCopy(parse_hdlr_t * psPH, int Tok, char * pcDst, size_t szDst);
+
+/**
+ * @brief	Build the hashed key set(s) of a table, thread safe, done once on first use
+ * @param	psEntries - table, keys must not change once built
+ * @return	erSUCCESS or erFAILURE if no memory
+ * @note	Called by xJsonParseEntries(), call during init to avoid the first use cost
+ */
+int xJsonEntriesBuild(ph_entries_t * psEntries);
+
+/**
+ * @brief	Release the key set(s) of a table, not while in use by a parse
+ */
+void vJsonEntriesRelease(ph_entries_t * psEntries);
+
+/**
+ * @brief	Parse all entries of a table in a single walk through the tokens
+ * @return	bitmap of entries found and parsed successfully, bit N = Entry[N]
+ * @note	All entries are parsed but only the first 64 can be reported
+ * @note	Key set built on the first walk and retained in psEntries->psKeys
+ */
+u64_t xJsonParseEntries(parse_hdlr_t * psPH, ph_entries_t * psEntries);
+
+/**
+ * @brief	Build next sibling array, allows complete objects/arrays to be skipped in 1 step
+ * @return	number of tokens covered or erFAILURE
+ * @note	Built on demand by xJsonFindPath()
+ */
+int xJsonSkipBuild(parse_hdlr_t * psPH);
+
+/**
+ * @brief	Find a value using a JSON Pointer (RFC6901) style path eg "/device/sensors/3/value"
+ * @param	pcPath - path, "" for the root value, "~0" and "~1" escape '~' and '/' in keys
+ * @return	index of value token (also CurTok & psTx) or erFAILURE if not found
+ */
+int xJsonFindPath(parse_hdlr_t * psPH, const char * pcPath);
+
+/**
+ * @brief	Find the parent of a token, for a value in an object this is its key
+ * @return	index of parent token or erFAILURE if none (root) or invalid
+ * @note	Direct with compact tokens (jsonTOKEN_PARENT) or jsmn parent links, else via the skip array
+ */
+int xJsonParent(parse_hdlr_t * psPH, int Tok);
+
+/**
+ * @brief	Re-emit a parsed value (complete document or subtree) minified or indented
+ * @param	Tok - index of the value token, 0 for the root
+ * @param	psUB - destination, NULL to only measure the output size
+ * @param	Indent - spaces per nesting level, 0 for minified output
+ * @return	number of bytes (to be) written, erJSON_BUF_FULL if truncated,
+ *			erFAILURE if Tok invalid, value incomplete or nested deeper than jsonEMIT_MAX_DEPTH
+ * @note	Strings and primitives are copied as is from the source, escapes are not altered.
+ *			Strings decoded by xJsonStringView() are escaped again.
+ */
+int xJsonEmit(parse_hdlr_t * psPH, int Tok, ubuf_t * psUB, int Indent);
+
+/**
+ * @brief	Report the complete parsed document indented 2 spaces per level, via a bounded buffer
+ * @param	Depth - number of levels all lines are indented by
+ * @return	number of characters reported or erFAILURE
+ */
+int xJsonReportTokens(parse_hdlr_t * psPH, int Depth);
+
 /**
  * @brief
  */
@@ -0,0 +1,499 @@
+/*
+ * saxX.c - Copyright 2014-25 Andre M. Maree / KSS Technologies (Pty) Ltd.
+ *
+ * Tokenless, event driven, JSON parser.
+ * Source buffer conventions as per parse_hdlr_t, no tokens are built, only a nesting bit stack
+ * (object vs array per level) is maintained. Each value is reported to the callback as found.
+ */
+
+#include "hal_platform.h"
+#include "saxX.h"
+#include "syslog.h"
+#include "errors_events.h"
+#include "swarX.h"
+
+#include <string.h>
+
+// ############################### BUILD: debug configuration options ##############################
+
+#define	debugFLAG					0xF000
+#define	debugPARSE					(debugFLAG & 0x0001)
+#define	debugTIMING					(debugFLAG_GLOBAL & debugFLAG & 0x1000)
+#define	debugTRACK					(debugFLAG_GLOBAL & debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG_GLOBAL & debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG_GLOBAL & debugFLAG & 0x8000)
+
+// ######################################## enumerations ###########################################
+
+enum {
+	stVALUE,											// expect value
+	stVALUE_END,										// after '[', expect value or ']'
+	stKEY,												// after ',' in object, expect key
+	stKEY_END,											// after '{', expect key or '}'
+	stCOLON,											// after key, expect ':'
+	stNEXT,												// after value in object/array, expect ',' or close
+	stDONE,												// root value complete
+};
+
+// ###################################### local variables ##########################################
+
+enum {													// validation character classes
+	vcWS		= 0x01,									// white space
+	vcDIGIT		= 0x02,									// 0 -> 9
+	vcHEX		= 0x04,									// 0 -> 9, a -> f, A -> F
+	vcESC		= 0x08,									// valid character following '\\' (except 'u')
+	vcSTR		= 0x10,									// string character requiring attention
+};
+
+static const u8_t ValClass[256] = {
+	[0x00 ... 0x08] = vcSTR, ['\t'] = vcWS | vcSTR, ['\n'] = vcWS | vcSTR, [0x0B ... 0x0C] = vcSTR,
+	['\r'] = vcWS | vcSTR, [0x0E ... 0x1F] = vcSTR, [' '] = vcWS,
+	[CHR_DOUBLE_QUOTE] = vcESC | vcSTR, [CHR_BACKSLASH] = vcESC | vcSTR, ['/'] = vcESC,
+	['0' ... '9'] = vcDIGIT | vcHEX, ['A' ... 'F'] = vcHEX, ['a'] = vcHEX, ['b'] = vcHEX | vcESC,
+	['c' ... 'e'] = vcHEX, ['f'] = vcHEX | vcESC, ['n'] = vcESC, ['r'] = vcESC, ['t'] = vcESC,
+	[0x80 ... 0xFF] = vcSTR,
+};
+
+// ####################################### Local Functions #########################################
+
+/**
+ * @brief	find the closing quote of a string
+ * @param	pcBuf - first character AFTER the opening quote
+ * @return	pointer to closing quote or NULL if end of buffer reached
+ */
+static const char * pcJsonStringEnd(const char * pcBuf, const char * pcEnd) {
+	while (pcBuf < pcEnd) {
+		if (*pcBuf == CHR_DOUBLE_QUOTE)
+			return pcBuf;
+		pcBuf += (*pcBuf == CHR_BACKSLASH) ? 2 : 1;
+	}
+	return NULL;
+}
+
+/**
+ * @brief	find the end of a primitive, ie next white space or structural character
+ */
+static const char * pcJsonPrimitiveEnd(const char * pcBuf, const char * pcEnd) {
+	while (pcBuf < pcEnd) {
+		switch (*pcBuf) {
+		case ' ': case '\t': case '\r': case '\n': case ',': case ':': case ']': case '}': case '\0':
+			return pcBuf;
+		default:
+			++pcBuf;
+		}
+	}
+	return pcBuf;
+}
+
+/**
+ * @brief	skip a complete object or array, no callbacks and minimal checking
+ * @param	pcBuf - opening '{' or '['
+ * @return	pointer to character following the closing bracket or NULL if incomplete
+ */
+static const char * pcJsonSkipValue(const char * pcBuf, const char * pcEnd) {
+	int Level = 0;
+	while (pcBuf < pcEnd) {
+		switch (*pcBuf++) {
+		case CHR_L_CURLY: case CHR_L_SQUARE:
+			++Level;
+			break;
+		case CHR_R_CURLY: case CHR_R_SQUARE:
+			if (--Level == 0)
+				return pcBuf;
+			break;
+		case CHR_DOUBLE_QUOTE:
+			pcBuf = pcJsonStringEnd(pcBuf, pcEnd);
+			if (pcBuf == NULL)
+				return NULL;
+			++pcBuf;
+			break;
+		default:
+			break;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief	validate a UTF-8 multi byte sequence, shortest form, no surrogates, max U+10FFFF
+ * @param	pcBuf - lead byte (>= 0x80)
+ * @return	length of sequence, JSMN_ERROR_INVAL or JSMN_ERROR_PART if truncated
+ */
+static int xJsonValidUTF8(const char * pcBuf, const char * pcEnd) {
+	u8_t u8Lead = *pcBuf, u8Lo = 0x80, u8Hi = 0xBF;
+	if (u8Lead < 0xC2 || u8Lead > 0xF4)
+		return JSMN_ERROR_INVAL;
+	int Len = (u8Lead < 0xE0) ? 2 : (u8Lead < 0xF0) ? 3 : 4;
+	if (u8Lead == 0xE0)			u8Lo = 0xA0;			// overlong 3 byte
+	else if (u8Lead == 0xED)	u8Hi = 0x9F;			// surrogates
+	else if (u8Lead == 0xF0)	u8Lo = 0x90;			// overlong 4 byte
+	else if (u8Lead == 0xF4)	u8Hi = 0x8F;			// > U+10FFFF
+	for (int Idx = 1; Idx < Len; ++Idx, u8Lo = 0x80, u8Hi = 0xBF) {
+		if (pcBuf + Idx >= pcEnd)
+			return JSMN_ERROR_PART;
+		u8_t u8Cont = pcBuf[Idx];
+		if (u8Cont < u8Lo || u8Cont > u8Hi)
+			return JSMN_ERROR_INVAL;
+	}
+	return Len;
+}
+
+/**
+ * @brief	validate a string, 8 characters at a time while none require attention
+ * @param	ppcNow - in: first character AFTER the opening quote, out: after closing quote or error position
+ * @return	erSUCCESS, JSMN_ERROR_INVAL or JSMN_ERROR_PART
+ */
+static int xJsonValidString(const char ** ppcNow, const char * pcEnd) {
+	const char * pcNow = *ppcNow;
+	int iRV = erSUCCESS;
+	while (1) {
+		while ((pcEnd - pcNow) >= 8) {
+			uint64_t u64 = swarLoad(pcNow);
+			uint64_t u64Hit = (u64 & swarHIGHS) | swarHAS_LESS(u64, 0x20) | swarHAS_BYTE(u64, CHR_DOUBLE_QUOTE) | swarHAS_BYTE(u64, CHR_BACKSLASH);
+			if (u64Hit) {								// straight to the 1st character requiring attention
+				pcNow += swarFIRST(u64Hit);
+				break;
+			}
+			pcNow += 8;
+		}
+		if (pcNow >= pcEnd) {
+			iRV = JSMN_ERROR_PART;
+			break;
+		}
+		u8_t u8Chr = *pcNow;
+		if ((ValClass[u8Chr] & vcSTR) == 0) {
+			++pcNow;
+			continue;
+		}
+		if (u8Chr == CHR_DOUBLE_QUOTE) {
+			++pcNow;
+			break;
+		}
+		if (u8Chr == CHR_BACKSLASH) {
+			if ((pcEnd - pcNow) < 2) {
+				iRV = JSMN_ERROR_PART;
+				break;
+			}
+			if (pcNow[1] == 'u') {
+				int Idx;
+				for (Idx = 2; Idx < 6 && (pcNow + Idx) < pcEnd && (ValClass[(u8_t) pcNow[Idx]] & vcHEX); ++Idx);
+				if (Idx < 6) {
+					pcNow += Idx;
+					iRV = ((pcNow >= pcEnd) || *pcNow == 0) ? JSMN_ERROR_PART : JSMN_ERROR_INVAL;
+					break;
+				}
+				pcNow += 6;
+			} else if (ValClass[(u8_t) pcNow[1]] & vcESC) {
+				pcNow += 2;
+			} else {
+				++pcNow;
+				iRV = (*pcNow == 0) ? JSMN_ERROR_PART : JSMN_ERROR_INVAL;
+				break;
+			}
+			continue;
+		}
+		if (u8Chr < 0x20) {								// unescaped control, NUL is end of input
+			iRV = (u8Chr == 0) ? JSMN_ERROR_PART : JSMN_ERROR_INVAL;
+			break;
+		}
+		int Len = xJsonValidUTF8(pcNow, pcEnd);
+		if (Len < 0) {
+			iRV = Len;
+			break;
+		}
+		pcNow += Len;
+	}
+	*ppcNow = pcNow;
+	return iRV;
+}
+
+/**
+ * @brief	validate number grammar -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+ * @param	ppcNow - in: first character, out: after the number or error position
+ * @return	erSUCCESS, JSMN_ERROR_INVAL or JSMN_ERROR_PART
+ */
+static int xJsonValidNumber(const char ** ppcNow, const char * pcEnd) {
+	const char * pcNow = *ppcNow;
+	int iRV = erSUCCESS;
+	if (*pcNow == '-')
+		++pcNow;
+	if (pcNow < pcEnd && *pcNow == '0') {
+		++pcNow;
+	} else if (pcNow < pcEnd && *pcNow > '0' && *pcNow <= '9') {
+		while (++pcNow < pcEnd && (ValClass[(u8_t) *pcNow] & vcDIGIT));
+	} else {
+		goto digit_missing;
+	}
+	if (pcNow < pcEnd && *pcNow == '.') {
+		if (++pcNow >= pcEnd || (ValClass[(u8_t) *pcNow] & vcDIGIT) == 0)
+			goto digit_missing;
+		while (++pcNow < pcEnd && (ValClass[(u8_t) *pcNow] & vcDIGIT));
+	}
+	if (pcNow < pcEnd && (*pcNow == 'e' || *pcNow == 'E')) {
+		if (++pcNow < pcEnd && (*pcNow == '+' || *pcNow == '-'))
+			++pcNow;
+		if (pcNow >= pcEnd || (ValClass[(u8_t) *pcNow] & vcDIGIT) == 0)
+			goto digit_missing;
+		while (++pcNow < pcEnd && (ValClass[(u8_t) *pcNow] & vcDIGIT));
+	}
+	goto exit;
+digit_missing:
+	iRV = (pcNow >= pcEnd || *pcNow == 0) ? JSMN_ERROR_PART : JSMN_ERROR_INVAL;
+exit:
+	*ppcNow = pcNow;
+	return iRV;
+}
+
+/**
+ * @brief	validate one of the literals true, false or null
+ * @param	ppcNow - in: first character, out: after the literal or error position
+ * @return	erSUCCESS, JSMN_ERROR_INVAL or JSMN_ERROR_PART
+ */
+static int xJsonValidLiteral(const char ** ppcNow, const char * pcEnd) {
+	const char * pcNow = *ppcNow;
+	const char * pcLit = (*pcNow == 't') ? "true" : (*pcNow == 'f') ? "false" : "null";
+	while (*pcLit && pcNow < pcEnd && *pcNow == *pcLit) {
+		++pcNow;
+		++pcLit;
+	}
+	*ppcNow = pcNow;
+	if (*pcLit == 0)
+		return erSUCCESS;
+	return (pcNow >= pcEnd || *pcNow == 0) ? JSMN_ERROR_PART : JSMN_ERROR_INVAL;
+}
+
+// ####################################### Global Functions ########################################
+
+int xJsonParseEvents(parse_hdlr_t * psPH, sax_hdlr_t hdlrEvt) {
+	IF_myASSERT(debugPARAM, psPH->pcBuf && hdlrEvt);
+	const char * pcNow = psPH->pcBuf;
+	const char * pcEnd = pcNow + psPH->szBuf;
+	const char * pcVal;
+	u8_t Stack[saxMAX_DEPTH / 8];						// nesting bit stack, 1 = array
+	int Depth = 0, State = stVALUE, Count = 0, iRV, fSkip = 0;
+	sax_evt_e eEvt;
+	while (pcNow < pcEnd && *pcNow) {
+		char cChr = *pcNow;
+		if (cChr == ' ' || cChr == '\t' || cChr == '\r' || cChr == '\n') {
+			++pcNow;
+			continue;
+		}
+		switch (State) {
+		case stVALUE_END:
+			if (cChr == CHR_R_SQUARE)
+				goto close;
+			/* FALLTHRU */ /* no break */
+		case stVALUE:
+			pcVal = pcNow;
+			if (cChr == CHR_L_CURLY || cChr == CHR_L_SQUARE) {
+				if (fSkip == 0) {
+					iRV = hdlrEvt(psPH, (cChr == CHR_L_CURLY) ? saxOBJ_BEG : saxARR_BEG, pcNow, 1, Depth);
+					if (iRV < saxCONTINUE)
+						return iRV;
+					++Count;
+					fSkip = (iRV == saxSKIP);
+				}
+				if (fSkip) {							// fast skip to matching close
+					pcNow = pcJsonSkipValue(pcNow, pcEnd);
+					if (pcNow == NULL)
+						return JSMN_ERROR_PART;
+					fSkip = 0;
+					goto value_done;
+				}
+				if (Depth == saxMAX_DEPTH)
+					return JSMN_ERROR_NOMEM;
+				if (cChr == CHR_L_SQUARE) {
+					Stack[Depth >> 3] |= (1 << (Depth & 7));
+					State = stVALUE_END;
+				} else {
+					Stack[Depth >> 3] &= ~(1 << (Depth & 7));
+					State = stKEY_END;
+				}
+				++Depth;
+				++pcNow;
+				continue;
+			}
+			if (cChr == CHR_DOUBLE_QUOTE) {
+				pcNow = pcJsonStringEnd(++pcVal, pcEnd);
+				if (pcNow == NULL)
+					return JSMN_ERROR_PART;
+				eEvt = saxSTRING;
+				++pcNow;								// skip closing quote
+				iRV = pcNow - pcVal - 1;
+			} else if (strchr("-0123456789tfn", cChr)) {
+				pcNow = pcJsonPrimitiveEnd(pcNow, pcEnd);
+				eEvt = saxPRIMITIVE;
+				iRV = pcNow - pcVal;
+			} else {
+				return JSMN_ERROR_INVAL;
+			}
+			if (fSkip == 0) {
+				iRV = hdlrEvt(psPH, eEvt, pcVal, iRV, Depth);
+				if (iRV < saxCONTINUE)
+					return iRV;
+				++Count;
+			}
+			fSkip = 0;
+value_done:
+			State = Depth ? stNEXT : stDONE;
+			continue;
+
+		case stKEY_END:
+			if (cChr == CHR_R_CURLY)
+				goto close;
+			/* FALLTHRU */ /* no break */
+		case stKEY:
+			if (cChr != CHR_DOUBLE_QUOTE)
+				return JSMN_ERROR_INVAL;
+			pcVal = pcNow + 1;
+			pcNow = pcJsonStringEnd(pcVal, pcEnd);
+			if (pcNow == NULL)
+				return JSMN_ERROR_PART;
+			iRV = hdlrEvt(psPH, saxKEY, pcVal, pcNow - pcVal, Depth);
+			if (iRV < saxCONTINUE)
+				return iRV;
+			++Count;
+			fSkip = (iRV == saxSKIP);
+			++pcNow;
+			State = stCOLON;
+			continue;
+
+		case stCOLON:
+			if (cChr != CHR_COLON)
+				return JSMN_ERROR_INVAL;
+			++pcNow;
+			State = stVALUE;
+			continue;
+
+		case stNEXT:
+			if (cChr == CHR_COMMA) {
+				++pcNow;
+				State = (Stack[(Depth-1) >> 3] & (1 << ((Depth-1) & 7))) ? stVALUE : stKEY;
+				continue;
+			}
+			if (cChr != CHR_R_CURLY && cChr != CHR_R_SQUARE)
+				return JSMN_ERROR_INVAL;
+close:
+			--Depth;
+			eEvt = (Stack[Depth >> 3] & (1 << (Depth & 7))) ? saxARR_END : saxOBJ_END;
+			if (cChr != ((eEvt == saxARR_END) ? CHR_R_SQUARE : CHR_R_CURLY))
+				return JSMN_ERROR_INVAL;
+			iRV = hdlrEvt(psPH, eEvt, pcNow, 1, Depth);
+			if (iRV < saxCONTINUE)
+				return iRV;
+			++Count;
+			++pcNow;
+			State = Depth ? stNEXT : stDONE;
+			continue;
+
+		default:										// stDONE, only white space allowed
+			return JSMN_ERROR_INVAL;
+		}
+	}
+	if (State == stDONE)
+		return Count;
+	return (State == stVALUE && Depth == 0 && Count == 0) ? JSMN_ERROR_INVAL : JSMN_ERROR_PART;
+}
+
+int xJsonValidate(const char * pcBuf, size_t szBuf, size_t * pszErr) {
+	IF_myASSERT(debugPARAM, pcBuf);
+	const char * pcNow = pcBuf;
+	const char * pcEnd = pcBuf + szBuf;
+	u8_t Stack[saxMAX_DEPTH / 8];						// nesting bit stack, 1 = array
+	int Depth = 0, State = stVALUE, iRV = erSUCCESS;
+	while (pcNow < pcEnd && *pcNow) {
+		u8_t u8Chr = *pcNow;
+		if (ValClass[u8Chr] & vcWS) {
+			++pcNow;
+			continue;
+		}
+		switch (State) {
+		case stVALUE_END:
+			if (u8Chr == CHR_R_SQUARE)
+				goto close;
+			/* FALLTHRU */ /* no break */
+		case stVALUE:
+			if (u8Chr == CHR_L_CURLY || u8Chr == CHR_L_SQUARE) {
+				if (Depth == saxMAX_DEPTH) {
+					iRV = JSMN_ERROR_NOMEM;
+					goto exit;
+				}
+				if (u8Chr == CHR_L_SQUARE) {
+					Stack[Depth >> 3] |= (1 << (Depth & 7));
+					State = stVALUE_END;
+				} else {
+					Stack[Depth >> 3] &= ~(1 << (Depth & 7));
+					State = stKEY_END;
+				}
+				++Depth;
+				++pcNow;
+				continue;
+			}
+			if (u8Chr == CHR_DOUBLE_QUOTE) {
+				++pcNow;
+				iRV = xJsonValidString(&pcNow, pcEnd);
+			} else if (u8Chr == '-' || (ValClass[u8Chr] & vcDIGIT)) {
+				iRV = xJsonValidNumber(&pcNow, pcEnd);
+			} else if (u8Chr == 't' || u8Chr == 'f' || u8Chr == 'n') {
+				iRV = xJsonValidLiteral(&pcNow, pcEnd);
+			} else {
+				iRV = JSMN_ERROR_INVAL;
+			}
+			if (iRV < erSUCCESS)
+				goto exit;
+			State = Depth ? stNEXT : stDONE;
+			continue;
+
+		case stKEY_END:
+			if (u8Chr == CHR_R_CURLY)
+				goto close;
+			/* FALLTHRU */ /* no break */
+		case stKEY:
+			if (u8Chr != CHR_DOUBLE_QUOTE) {
+				iRV = JSMN_ERROR_INVAL;
+				goto exit;
+			}
+			++pcNow;
+			iRV = xJsonValidString(&pcNow, pcEnd);
+			if (iRV < erSUCCESS)
+				goto exit;
+			State = stCOLON;
+			continue;
+
+		case stCOLON:
+			if (u8Chr != CHR_COLON) {
+				iRV = JSMN_ERROR_INVAL;
+				goto exit;
+			}
+			++pcNow;
+			State = stVALUE;
+			continue;
+
+		case stNEXT:
+			if (u8Chr == CHR_COMMA) {
+				++pcNow;
+				State = (Stack[(Depth-1) >> 3] & (1 << ((Depth-1) & 7))) ? stVALUE : stKEY;
+				continue;
+			}
+close:
+			--Depth;
+			if (u8Chr != ((Stack[Depth >> 3] & (1 << (Depth & 7))) ? CHR_R_SQUARE : CHR_R_CURLY)) {
+				iRV = JSMN_ERROR_INVAL;
+				goto exit;
+			}
+			++pcNow;
+			State = Depth ? stNEXT : stDONE;
+			continue;
+
+		default:										// stDONE, only white space allowed
+			iRV = JSMN_ERROR_INVAL;
+			goto exit;
+		}
+	}
+	if (State != stDONE)								// nothing (but white space) is invalid
+		iRV = (State == stVALUE && Depth == 0) ? JSMN_ERROR_INVAL : JSMN_ERROR_PART;
+exit:
+	if (iRV < erSUCCESS && pszErr)
+		*pszErr = pcNow - pcBuf;
+	return iRV;
+}
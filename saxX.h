@@ -0,0 +1,68 @@
+// saxX.h
+
+#pragma once
+
+#include "parserX.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ########################################## macros ###############################################
+
+#define	saxMAX_DEPTH				64					// maximum object/array nesting level
+
+// ######################################## enumerations ###########################################
+
+typedef enum {
+	saxOBJ_BEG,											// '{'
+	saxOBJ_END,											// '}'
+	saxARR_BEG,											// '['
+	saxARR_END,											// ']'
+	saxKEY,												// key, without quotes, escapes not decoded
+	saxSTRING,											// string value, without quotes, escapes not decoded
+	saxPRIMITIVE,										// number, true, false or null
+} sax_evt_e;
+
+enum {
+	saxCONTINUE = 0,									// callback return values, < 0 aborts parsing
+	saxSKIP,											// skip subtree (xxx_BEG) or value (KEY)
+};
+
+// ############################################ structures #########################################
+
+/**
+ * @brief	event callback
+ * @param	psPH - parse handler, pcBuf/szBuf source and pvArg user context
+ * @param	eEvt - event type
+ * @param	pcVal - start of event text in pcBuf
+ * @param	szVal - length of event text
+ * @param	Depth - nesting level of event, root value = 0
+ * @return	saxCONTINUE, saxSKIP or < 0 to abort
+ */
+typedef int (* sax_hdlr_t)(parse_hdlr_t * psPH, sax_evt_e eEvt, const char * pcVal, size_t szVal, int Depth);
+
+// ####################################### global functions ########################################
+
+/**
+ * @brief	Tokenless event driven parse of pcBuf/szBuf, no token memory required
+ * @param	psPH - parse handler, only pcBuf, szBuf and pvArg used
+ * @param	hdlrEvt - callback for each event
+ * @return	number of events reported, JSMN_ERROR_xxx (or callback value) if < 0
+ */
+int xJsonParseEvents(parse_hdlr_t * psPH, sax_hdlr_t hdlrEvt);
+
+/**
+ * @brief	Strict (RFC 8259) well-formedness check, no tokens, callbacks or allocation
+ * @param	pcBuf - source, scanning stops at szBuf or a NUL character
+ * @param	pszErr - if not NULL, set to the offset of the offending character on failure
+ * @return	erSUCCESS, JSMN_ERROR_INVAL if malformed, JSMN_ERROR_PART if truncated or
+ *			JSMN_ERROR_NOMEM if nested deeper than saxMAX_DEPTH
+ * @note	Checks structure, string escapes, UTF-8 (no overlong, surrogate or > U+10FFFF),
+ *			number grammar and literals. Keys are not checked for uniqueness.
+ */
+int xJsonValidate(const char * pcBuf, size_t szBuf, size_t * pszErr);
+
+#ifdef __cplusplus
+}
+#endif
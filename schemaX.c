@@ -0,0 +1,179 @@
+/*
+ * schemaX.c - Copyright 2014-25 Andre M. Maree / KSS Technologies (Pty) Ltd.
+ *
+ * Schema driven decoding, keys resolved with a collision free (perfect) hash of the field names.
+ * Only members of the addressed object are visited, nested values are skipped in a single step.
+ */
+
+#include "hal_platform.h"
+#include "schemaX.h"
+#include "numberX.h"
+#include "syslog.h"
+
+#include <sched.h>
+#include <string.h>
+
+// ############################### BUILD: debug configuration options ##############################
+
+#define	debugFLAG					0xF000
+#define	debugTIMING					(debugFLAG_GLOBAL & debugFLAG & 0x1000)
+#define	debugTRACK					(debugFLAG_GLOBAL & debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG_GLOBAL & debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG_GLOBAL & debugFLAG & 0x8000)
+
+#define	jsonSCHEMA_MAX_SEEDS		4096
+
+// ######################################## Local Functions ########################################
+
+/**
+ * @brief	map slot of a key, FNV-1a finalised so every bit of the seed & key reaches the slot bits
+ * @note	the low N bits of FNV-1a depend only on the low N bits of the seed & key bytes, masked
+ *			directly a map of 2^N slots would offer no more than 2^N distinct seeds
+ */
+static u32_t xJsonSchemaSlot(u32_t Seed, const char * pcKey, size_t szKey, u32_t Mask) {
+	u32_t Hash = xJsonHash(Seed, pcKey, szKey);
+	Hash ^= Hash >> 16;
+	Hash *= 0x85EBCA6BUL;
+	Hash ^= Hash >> 13;
+	return Hash & Mask;
+}
+
+/**
+ * @brief	search for a seed giving a collision free map of the field names
+ * @return	seed found (map filled in) or jsonSCHEMA_FAILED
+ */
+static u32_t xJsonSchemaSearch(json_schema_t * psS) {
+	IF_myASSERT(debugPARAM, psS->NumFields <= 64 && (psS->NumFields * 2) <= psS->szMap);
+	u32_t Mask = psS->szMap - 1;
+	for (u32_t Seed = jsonHASH_INIT; Seed < (jsonHASH_INIT + jsonSCHEMA_MAX_SEEDS); ++Seed) {
+		memset(psS->pu8Map, 0, psS->szMap);
+		int Idx;
+		for (Idx = 0; Idx < psS->NumFields; ++Idx) {
+			const json_field_t * psF = &psS->psFields[Idx];
+			u32_t Slot = xJsonSchemaSlot(Seed, psF->pcKey, psF->szKey, Mask);
+			if (psS->pu8Map[Slot])
+				break;									// collision, try next seed
+			psS->pu8Map[Slot] = Idx + 1;
+		}
+		if (Idx == psS->NumFields)
+			return Seed;
+	}
+	SL_ERR("No perfect hash for %d fields", psS->NumFields);
+	return jsonSCHEMA_FAILED;
+}
+
+// ####################################### Global Functions ########################################
+
+int xJsonSchemaBuild(json_schema_t * psS) {
+	u32_t Seed = 0;
+	if (__atomic_compare_exchange_n(&psS->Seed, &Seed, jsonSCHEMA_BUILDING, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+		Seed = xJsonSchemaSearch(psS);					// ours to build, map complete before Seed published
+		__atomic_store_n(&psS->Seed, Seed, __ATOMIC_RELEASE);
+	} else {
+		while (Seed == jsonSCHEMA_BUILDING) {			// being built by another task, wait for the result
+			sched_yield();
+			Seed = __atomic_load_n(&psS->Seed, __ATOMIC_ACQUIRE);
+		}
+	}
+	return (Seed == jsonSCHEMA_FAILED) ? erFAILURE : erSUCCESS;
+}
+
+/**
+ * @brief	decode a single value token into a struct member
+ * @return	1 if decoded else 0
+ */
+static int xJsonSchemaValue(parse_hdlr_t * psPH, jsontok_t * psT, const json_field_t * psF, void * pvStruct) {
+	px_t pX = { .pv = (u8_t *) pvStruct + psF->Offset };
+	const char * pcSrc = psPH->pcBuf + psT->start;
+	size_t szSrc = psT->end - psT->start;
+	if (psF->cvI == cvSXX)								// escapes decoded, truncated to fit
+		return (psF->Size > 0) && (xJsonStringCopy(psPH, psT - psPH->psT0, pX.pc8, psF->Size) >= erSUCCESS);
+	return (psT->type == JSMN_PRIMITIVE) && (xJsonParseNumber(pcSrc, szSrc, pX, psF->cvI) == erSUCCESS);
+}
+
+/**
+ * @brief	check schema, token and skip array ready for decoding an object
+ * @return	erSUCCESS if ready else erFAILURE
+ */
+static int xJsonSchemaReady(parse_hdlr_t * psPH, int Tok, json_schema_t * psS) {
+	u32_t Seed = __atomic_load_n(&psS->Seed, __ATOMIC_ACQUIRE);
+	if (Seed == jsonSCHEMA_FAILED)
+		return erFAILURE;								// failed before, not retried
+	if ((Seed == 0 || Seed == jsonSCHEMA_BUILDING) && xJsonSchemaBuild(psS) != erSUCCESS)
+		return erFAILURE;
+	if (Tok < 0 || Tok >= psPH->NumTok || psPH->psT0[Tok].type != JSMN_OBJECT)
+		return erFAILURE;
+	if (psPH->NumNext != psPH->NumTok && xJsonSkipBuild(psPH) < erSUCCESS)
+		return erFAILURE;
+	return erSUCCESS;
+}
+
+/**
+ * @brief	resolve a key token to a schema field
+ * @return	field index or -1 if not a schema key
+ */
+static int xJsonSchemaField(parse_hdlr_t * psPH, jsontok_t * psK, json_schema_t * psS) {
+	const char * pcKey = psPH->pcBuf + psK->start;
+	size_t szKey = psK->end - psK->start;
+	int Idx = psS->pu8Map[xJsonSchemaSlot(psS->Seed, pcKey, szKey, psS->szMap - 1)] - 1;
+	if (Idx < 0)
+		return -1;										// empty slot, not a schema key
+	const json_field_t * psF = &psS->psFields[Idx];
+	return (psF->szKey == szKey && memcmp(psF->pcKey, pcKey, szKey) == 0) ? Idx : -1;
+}
+
+int xJsonSchemaDecode(parse_hdlr_t * psPH, int Tok, json_schema_t * psS, void * pvStruct, u64_t * pu64Found) {
+	if (xJsonSchemaReady(psPH, Tok, psS) != erSUCCESS)
+		return erFAILURE;
+	u64_t Found = 0;
+	int NumFound = 0;
+	int Key = Tok + 1;
+	for (int Count = psPH->psT0[Tok].size; Count; --Count, Key = psPH->piNext[Key]) {
+		int Idx = xJsonSchemaField(psPH, &psPH->psT0[Key], psS);
+		if (Idx < 0 || (Found & (1ULL << Idx)))
+			continue;									// different key or duplicate
+		if (xJsonSchemaValue(psPH, &psPH->psT0[Key + 1], &psS->psFields[Idx], pvStruct)) {
+			Found |= 1ULL << Idx;
+			++NumFound;
+		}
+	}
+	if (pu64Found)
+		*pu64Found = Found;
+	return NumFound;
+}
+
+int xJsonSchemaEncodeColumns(json_obj_t * pJson, const json_schema_t * psS, const void * pvRecs, size_t NumRec) {
+	for (int Idx = 0; Idx < psS->NumFields; ++Idx) {
+		const json_field_t * psF = &psS->psFields[Idx];
+		px_t pX = { .pv = (u8_t *) pvRecs + psF->Offset };
+		int iRV = ecJsonAddKeyColumn(pJson, psF->pcKey, pX, psF->cvI, NumRec, psS->szStruct);
+		if (iRV != erSUCCESS)
+			return iRV;
+	}
+	return erSUCCESS;
+}
+
+int xJsonSchemaDecodeColumns(parse_hdlr_t * psPH, int Tok, json_schema_t * psS, void * pvRecs, size_t MaxRec) {
+	if (xJsonSchemaReady(psPH, Tok, psS) != erSUCCESS)
+		return erFAILURE;
+	u64_t Found = 0;
+	size_t NumRec = 0;
+	int Key = Tok + 1;
+	for (int Count = psPH->psT0[Tok].size; Count; --Count, Key = psPH->piNext[Key]) {
+		int Idx = xJsonSchemaField(psPH, &psPH->psT0[Key], psS);
+		if (Idx < 0 || (Found & (1ULL << Idx)) || psPH->psT0[Key + 1].type != JSMN_ARRAY)
+			continue;									// not a schema key, duplicate or not a column
+		Found |= 1ULL << Idx;
+		const json_field_t * psF = &psS->psFields[Idx];
+		size_t Num = psPH->psT0[Key + 1].size;
+		if (Num > MaxRec)
+			Num = MaxRec;
+		u8_t * pu8Rec = pvRecs;
+		int Val = Key + 2;								// first element of the column
+		for (size_t Rec = 0; Rec < Num; ++Rec, Val = psPH->piNext[Val], pu8Rec += psS->szStruct)
+			xJsonSchemaValue(psPH, &psPH->psT0[Val], psF, pu8Rec);
+		if (Num > NumRec)
+			NumRec = Num;
+	}
+	return NumRec;
+}
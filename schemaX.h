@@ -0,0 +1,156 @@
+// schemaX.h - single declaration of a C struct's JSON layout, generating encoder & decoder
+
+#pragma once
+
+#include <stddef.h>
+
+#include "parserX.h"
+#include "writerX.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Declare the fields once, as an X-macro list of X(Type, Member, Kind) entries:
+ *
+ *	#define SENSOR_FIELDS(X, T)		X(T, ts, U64) X(T, temp, F32) X(T, name, STR)
+ *	jsonSCHEMA_DEFINE(sensor, sensor_t, SENSOR_FIELDS)		// in one .c file
+ *	jsonSCHEMA_DECLARE(sensor, sensor_t)					// in header(s) as required
+ *
+ * generates
+ *	json_schema_t sensorSchema;											field descriptors
+ *	int sensorEncode(json_obj_t * pJson, const sensor_t * psV);			straight line, into open object, writer status
+ *	int sensorDecode(parse_hdlr_t * psPH, int Tok, sensor_t * psV, u64_t * pu64Found);	fields decoded
+ *	int sensorEncodeColumns(json_obj_t * pJson, const sensor_t * psV, size_t Num);
+ *	int sensorDecodeColumns(parse_hdlr_t * psPH, int Tok, sensor_t * psV, size_t Max);
+ *
+ * Columnar form writes an array of records as { "ts":[...], "temp":[...], "name":[...] }
+ *
+ * Kind is one of U08 U16 U32 U64 I08 I16 I32 I64 F32 F64 or STR (char array member)
+ * Member names are used as keys, hence not escaped. Maximum 64 fields per schema.
+ */
+
+// ########################################## macros ###############################################
+
+#define	jsonCVI_U08					cvU08
+#define	jsonCVI_U16					cvU16
+#define	jsonCVI_U32					cvU32
+#define	jsonCVI_U64					cvU64
+#define	jsonCVI_I08					cvI08
+#define	jsonCVI_I16					cvI16
+#define	jsonCVI_I32					cvI32
+#define	jsonCVI_I64					cvI64
+#define	jsonCVI_F32					cvF32
+#define	jsonCVI_F64					cvF64
+#define	jsonCVI_STR					cvSXX
+
+#define	jsonPUT_U08(pJ, V)			ecJsonPutU64(pJ, V)
+#define	jsonPUT_U16(pJ, V)			ecJsonPutU64(pJ, V)
+#define	jsonPUT_U32(pJ, V)			ecJsonPutU64(pJ, V)
+#define	jsonPUT_U64(pJ, V)			ecJsonPutU64(pJ, V)
+#define	jsonPUT_I08(pJ, V)			ecJsonPutI64(pJ, V)
+#define	jsonPUT_I16(pJ, V)			ecJsonPutI64(pJ, V)
+#define	jsonPUT_I32(pJ, V)			ecJsonPutI64(pJ, V)
+#define	jsonPUT_I64(pJ, V)			ecJsonPutI64(pJ, V)
+#define	jsonPUT_F32(pJ, V)			ecJsonPutF32(pJ, V)
+#define	jsonPUT_F64(pJ, V)			ecJsonPutF64(pJ, V)
+#define	jsonPUT_STR(pJ, V)			ecJsonPutStr(pJ, V)
+
+#define	jsonSCHEMA_BUILDING			1					// Seed while the map is being built
+#define	jsonSCHEMA_FAILED			2					// Seed if no collision free map found, not retried
+
+// perfect hash map size, 4x number of fields rounded up to power of 2, 8x above 32 fields
+#define	jsonSCHEMA_MAP_SIZE(n)		((n) <= 2 ? 8 : (n) <= 4 ? 16 : (n) <= 8 ? 32 : (n) <= 16 ? 64 : (n) <= 32 ? 128 : 512)
+
+#define	jsonFIELD_DESC(T, M, K)		{ #M, sizeof(#M) - 1, offsetof(T, M), sizeof(((T *) 0)->M), jsonCVI_##K },
+#define	jsonFIELD_ENCODE(T, M, K)	ecJsonPutKey(pJson, #M, sizeof(#M) - 1); jsonPUT_##K(pJson, psV->M);
+
+#define	jsonSCHEMA_DECLARE(Name, Type)											\
+	extern json_schema_t Name##Schema;											\
+	int Name##Encode(json_obj_t * pJson, const Type * psV);						\
+	int Name##Decode(parse_hdlr_t * psPH, int Tok, Type * psV, u64_t * pu64Found);	\
+	int Name##EncodeColumns(json_obj_t * pJson, const Type * psV, size_t Num);	\
+	int Name##DecodeColumns(parse_hdlr_t * psPH, int Tok, Type * psV, size_t Max);
+
+#define	jsonSCHEMA_DEFINE(Name, Type, FIELDS)									\
+	static const json_field_t Name##Fields[] = { FIELDS(jsonFIELD_DESC, Type) };	\
+	static u8_t Name##Map[jsonSCHEMA_MAP_SIZE(sizeof(Name##Fields) / sizeof(json_field_t))];	\
+	json_schema_t Name##Schema = {												\
+		.psFields = Name##Fields,												\
+		.pu8Map = Name##Map,													\
+		.szStruct = sizeof(Type),												\
+		.NumFields = sizeof(Name##Fields) / sizeof(json_field_t),				\
+		.szMap = sizeof(Name##Map),												\
+	};																			\
+	int Name##Encode(json_obj_t * pJson, const Type * psV) {					\
+		FIELDS(jsonFIELD_ENCODE, Type)											\
+		return ecJsonStatus(pJson);												\
+	}																			\
+	int Name##Decode(parse_hdlr_t * psPH, int Tok, Type * psV, u64_t * pu64Found) {	\
+		return xJsonSchemaDecode(psPH, Tok, &Name##Schema, psV, pu64Found);	\
+	}																			\
+	int Name##EncodeColumns(json_obj_t * pJson, const Type * psV, size_t Num) {	\
+		return xJsonSchemaEncodeColumns(pJson, &Name##Schema, psV, Num);		\
+	}																			\
+	int Name##DecodeColumns(parse_hdlr_t * psPH, int Tok, Type * psV, size_t Max) {	\
+		return xJsonSchemaDecodeColumns(psPH, Tok, &Name##Schema, psV, Max);	\
+	}
+
+// ############################################ structures #########################################
+
+typedef struct json_field_t {
+	const char * pcKey;									// key, same as struct member name
+	u8_t szKey;											// length of key
+	u32_t Offset;										// offset of member in struct
+	u32_t Size;											// size of member, STR buffer size
+	cvi_e cvI;											// cvU08 -> cvF64 or cvSXX
+} json_field_t;
+
+typedef struct json_schema_t {
+	const json_field_t * psFields;
+	u8_t * pu8Map;										// perfect hash slot -> field# + 1, built on first use
+	u32_t Seed;											// hash seed for collision free map, 0 if not built, see jsonSCHEMA_FAILED
+	u32_t szStruct;
+	u8_t NumFields;
+	u16_t szMap;										// number of slots in pu8Map, power of 2
+} json_schema_t;
+
+// ####################################### global functions ########################################
+
+/**
+ * @brief	Build the collision free key map for a schema, done automatically on first decode
+ * @return	erSUCCESS or erFAILURE if no seed found (duplicate member names), failure is remembered
+ * @note	Thread safe, concurrent callers wait for a single build. Call during init to keep the
+ *			search out of the first decode.
+ */
+int xJsonSchemaBuild(json_schema_t * psS);
+
+/**
+ * @brief	Decode the members of an object into a struct as described by a schema
+ * @param	Tok - token index of the object (0 for root)
+ * @param	pvStruct - structure to be filled in
+ * @param	pu64Found - if not NULL, bitmap of fields decoded, bit N = field N
+ * @return	number of fields decoded or erFAILURE if schema map not built, Tok not an object
+ *			or skip array could not be built
+ */
+int xJsonSchemaDecode(parse_hdlr_t * psPH, int Tok, json_schema_t * psS, void * pvStruct, u64_t * pu64Found);
+
+/**
+ * @brief	Encode an array of structs, 1 column (key : [values]) per field, into an open object
+ * @param	pvRecs - first of NumRec consecutive structs
+ * @return	erSUCCESS or writer error code
+ */
+int xJsonSchemaEncodeColumns(json_obj_t * pJson, const json_schema_t * psS, const void * pvRecs, size_t NumRec);
+
+/**
+ * @brief	Decode columns (key : [values]) of an object into an array of structs
+ * @param	Tok - token index of the object (0 for root)
+ * @param	pvRecs - array of MaxRec structs to be filled in, members without a value left as is
+ * @return	number of records, longest column decoded limited to MaxRec, or erFAILURE as xJsonSchemaDecode()
+ */
+int xJsonSchemaDecodeColumns(parse_hdlr_t * psPH, int Tok, json_schema_t * psS, void * pvRecs, size_t MaxRec);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,43 @@
+/*
+ * statsX.c - Copyright 2014-25 Andre M. Maree / KSS Technologies (Pty) Ltd.
+ *
+ * Counters & log2 histograms, updated with relaxed atomics so concurrent documents don't serialise.
+ */
+
+#include "hal_platform.h"
+#include "statsX.h"
+
+#include <string.h>
+
+// ###################################### global variables #########################################
+
+#if (jsonSTATS == 1)
+json_stats_t sJsonStats;
+#endif
+
+// ####################################### Global Functions ########################################
+
+#if (jsonSTATS == 1)
+void vJsonStatsHist(json_hist_t * psH, u64_t Value) {
+	int Idx = (Value < 2) ? 0 : 63 - __builtin_clzll(Value);
+	if (Idx >= jsonSTATS_BUCKETS)
+		Idx = jsonSTATS_BUCKETS - 1;
+	__atomic_fetch_add(&psH->Count, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&psH->Sum, Value, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&psH->Bucket[Idx], 1, __ATOMIC_RELAXED);
+	u64_t Max = __atomic_load_n(&psH->Max, __ATOMIC_RELAXED);
+	while (Value > Max && !__atomic_compare_exchange_n(&psH->Max, &Max, Value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+#endif
+
+void vJsonStatsSnapshot(json_stats_t * psS, int fReset) {
+	#if (jsonSTATS == 1)
+	u64_t * pu64Src = (u64_t *) &sJsonStats;
+	u64_t * pu64Dst = (u64_t *) psS;
+	for (size_t i = 0; i < (sizeof(json_stats_t) / sizeof(u64_t)); ++i)
+		pu64Dst[i] = fReset ? __atomic_exchange_n(&pu64Src[i], 0, __ATOMIC_RELAXED) : __atomic_load_n(&pu64Src[i], __ATOMIC_RELAXED);
+	#else
+	(void) fReset;
+	memset(psS, 0, sizeof(json_stats_t));
+	#endif
+}
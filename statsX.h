@@ -0,0 +1,109 @@
+// statsX.h - optional (build time) run time statistics for parser & writer hot paths
+
+#pragma once
+
+#include "complex_vars.h"
+
+#ifndef jsonSTATS
+	#define	jsonSTATS				0					// 1 = collect statistics
+#endif
+
+#if (jsonSTATS == 1)
+	#if defined(ESP_PLATFORM)
+		#include "esp_cpu.h"
+	#else
+		#include <time.h>
+	#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ########################################## macros ###############################################
+
+#define	jsonSTATS_BUCKETS			24					// log2 buckets, N = [2^N, 2^(N+1)), last open ended
+
+#if (jsonSTATS == 1)
+	#define	jsonSTAT_ADD(Field, Val)	__atomic_fetch_add(&sJsonStats.Field, (u64_t) (Val), __ATOMIC_RELAXED)
+	#define	jsonSTAT_T0(T0)				json_clk_t T0 = xJsonStatsClock()
+	// difference taken at counter width, correct across a single wrap, then widened
+	#define	jsonSTAT_HIST(Hist, T0)		vJsonStatsHist(&sJsonStats.Hist, (json_clk_t) (xJsonStatsClock() - (T0)))
+	// per document counters, kept in each json_obj_t & folded into the parent on close
+	#define	jsonSTAT_DOC(pJ, Field, Val)	(pJ)->Field += (Val)
+#else
+	#define	jsonSTAT_ADD(Field, Val)
+	#define	jsonSTAT_T0(T0)
+	#define	jsonSTAT_HIST(Hist, T0)
+	#define	jsonSTAT_DOC(pJ, Field, Val)
+#endif
+
+// ######################################## type definitions #######################################
+
+#if defined(ESP_PLATFORM)
+	typedef u32_t json_clk_t;							// CPU cycle counter, wraps every 2^32 cycles
+#else
+	typedef u64_t json_clk_t;							// nanoseconds
+#endif
+
+// ############################################ structures #########################################
+
+typedef struct json_hist_t {
+	u64_t Count;
+	u64_t Sum;
+	u64_t Max;
+	u64_t Bucket[jsonSTATS_BUCKETS];
+} json_hist_t;
+
+/**
+ * @brief	All members u64_t, snapshot & reset handle the structure as an array
+ * @note	Time unit is CPU cycles on ESP targets, nanoseconds elsewhere
+ */
+typedef struct json_stats_t {
+	json_hist_t Parse;									// xJsonParse() duration
+	json_hist_t Find;									// xJsonFindToken() duration
+	json_hist_t AddKV;									// ecJsonAddKeyValue() duration, completed calls
+	json_hist_t DocBytes;								// bytes emitted (or measured) per document
+	json_hist_t DocEscapes;								// escape sequences written per document
+	u64_t ParseTokens;									// tokens parsed
+	u64_t ParseBytes;									// source bytes parsed
+	u64_t TokAllocBytes;								// token arena bytes (re)allocated
+	u64_t FindCalls;									// xJsonFindToken() calls
+	u64_t FindProbes;									// tokens/index slots examined by xJsonFindToken()
+	u64_t WriteDocs;									// root objects (documents) closed
+	u64_t WriteBytes;									// bytes emitted (or measured)
+	u64_t WriteEscapes;									// escape sequences written
+} json_stats_t;
+
+// ####################################### global variables ########################################
+
+#if (jsonSTATS == 1)
+extern json_stats_t sJsonStats;
+#endif
+
+// ####################################### global functions ########################################
+
+#if (jsonSTATS == 1)
+static inline json_clk_t xJsonStatsClock(void) {
+	#if defined(ESP_PLATFORM)
+	return esp_cpu_get_cycle_count();
+	#else
+	struct timespec sTS;
+	clock_gettime(CLOCK_MONOTONIC, &sTS);
+	return (u64_t) sTS.tv_sec * 1000000000ULL + sTS.tv_nsec;
+	#endif
+}
+
+void vJsonStatsHist(json_hist_t * psH, u64_t Value);
+#endif
+
+/**
+ * @brief	Copy the statistics, optionally resetting them
+ * @param	psS - destination, zeroed if statistics not compiled in (jsonSTATS == 0)
+ * @param	fReset - 1 to reset each counter as it is read
+ */
+void vJsonStatsSnapshot(json_stats_t * psS, int fReset);
+
+#ifdef __cplusplus
+}
+#endif
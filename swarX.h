@@ -0,0 +1,51 @@
+// swarX.h - SIMD within a register helpers, 8 bytes at a time, used by scanning hot paths
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+	#define	swarSSE2				1
+#else
+	#define	swarSSE2				0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ########################################## macros ###############################################
+
+#define	swarONES					0x0101010101010101ULL
+#define	swarHIGHS					0x8080808080808080ULL
+#define	swarBCAST(c)				(swarONES * (uint8_t) (c))
+// non-zero if any byte in x is zero
+#define	swarHAS_ZERO(x)				(((x) - swarONES) & ~(x) & swarHIGHS)
+// non-zero if any byte in x equals c
+#define	swarHAS_BYTE(x, c)			swarHAS_ZERO((x) ^ swarBCAST(c))
+// non-zero if any byte in x is less than n (n <= 128)
+#define	swarHAS_LESS(x, n)			(((x) - swarBCAST(n)) & ~(x) & swarHIGHS)
+// offset of the first flagged byte in a non-zero result of the above, borrows only create false
+// flags above a real one so the lowest is exact, big endian returns 0 (rescan from block start)
+#if (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+	#define	swarFIRST(m)			(__builtin_ctzll(m) >> 3)
+#else
+	#define	swarFIRST(m)			0
+#endif
+
+// ####################################### global functions ########################################
+
+/**
+ * @brief	unaligned (and aliasing safe) load of 8 bytes
+ */
+static inline uint64_t swarLoad(const void * pvSrc) {
+	uint64_t u64;
+	memcpy(&u64, pvSrc, sizeof(u64));
+	return u64;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,183 @@
+/*
+ * tokenX.c - Copyright 2014-25 Andre M. Maree / KSS Technologies (Pty) Ltd.
+ *
+ * Compact token tokeniser, same algorithm, results & resume behaviour as jsmn_parse() (non strict)
+ * with 16 bit offsets. With parent links closing brackets & separators resolve in O(1).
+ */
+
+#include "hal_platform.h"
+#include "tokenX.h"
+
+#if (jsonTOKEN_COMPACT == 1)
+
+// ####################################### Local Functions #########################################
+
+static jsontok_t * psJsonTokAlloc(jsmn_parser * psP, jsontok_t * psT0, unsigned int NumTok) {
+	if (psP->toknext >= NumTok)
+		return NULL;
+	jsontok_t * psT = &psT0[psP->toknext++];
+	psT->start = psT->end = jsonTOK_UNSET;
+	psT->size = 0;
+	psT->spare = 0;
+	#if (jsonTOKEN_PARENT == 1)
+	psT->parent = jsonTOK_UNSET;
+	#endif
+	return psT;
+}
+
+static void vJsonTokFill(jsmn_parser * psP, jsontok_t * psT, u8_t Type, unsigned int Start, unsigned int End) {
+	psT->type = Type;
+	psT->start = Start;
+	psT->end = End;
+	psT->size = 0;
+	#if (jsonTOKEN_PARENT == 1)
+	psT->parent = (psP->toksuper < 0) ? jsonTOK_UNSET : psP->toksuper;
+	#else
+	(void) psP;
+	#endif
+}
+
+static int xJsonTokPrimitive(jsmn_parser * psP, const char * pcBuf, size_t szBuf, jsontok_t * psT0, unsigned int NumTok) {
+	unsigned int Start = psP->pos;
+	for (; psP->pos < szBuf && pcBuf[psP->pos] != CHR_NUL; psP->pos++) {
+		char cChr = pcBuf[psP->pos];
+		if (cChr == ':' || cChr == '\t' || cChr == '\r' || cChr == '\n' || cChr == ' ' || cChr == ',' || cChr == ']' || cChr == '}')
+			break;
+		if (cChr < 32 || cChr >= 127) {
+			psP->pos = Start;
+			return JSMN_ERROR_INVAL;
+		}
+	}
+	jsontok_t * psT = psJsonTokAlloc(psP, psT0, NumTok);
+	if (psT == NULL) {
+		psP->pos = Start;
+		return JSMN_ERROR_NOMEM;
+	}
+	vJsonTokFill(psP, psT, JSMN_PRIMITIVE, Start, psP->pos);
+	psP->pos--;
+	return 0;
+}
+
+static int xJsonTokString(jsmn_parser * psP, const char * pcBuf, size_t szBuf, jsontok_t * psT0, unsigned int NumTok) {
+	unsigned int Start = psP->pos++;
+	for (; psP->pos < szBuf && pcBuf[psP->pos] != CHR_NUL; psP->pos++) {
+		char cChr = pcBuf[psP->pos];
+		if (cChr == CHR_DOUBLE_QUOTE) {
+			jsontok_t * psT = psJsonTokAlloc(psP, psT0, NumTok);
+			if (psT == NULL) {
+				psP->pos = Start;
+				return JSMN_ERROR_NOMEM;
+			}
+			vJsonTokFill(psP, psT, JSMN_STRING, Start + 1, psP->pos);
+			return 0;
+		}
+		if (cChr == CHR_BACKSLASH && (psP->pos + 1) < szBuf) {
+			switch (pcBuf[++psP->pos]) {
+			case CHR_DOUBLE_QUOTE: case '/': case CHR_BACKSLASH: case 'b': case 'f': case 'r': case 'n': case 't': break;
+			case 'u':
+				psP->pos++;
+				for (int i = 0; i < 4 && psP->pos < szBuf && pcBuf[psP->pos] != CHR_NUL; i++, psP->pos++) {
+					char cHex = pcBuf[psP->pos] | 0x20;
+					if (!((cHex >= '0' && cHex <= '9') || (cHex >= 'a' && cHex <= 'f'))) {
+						psP->pos = Start;
+						return JSMN_ERROR_INVAL;
+					}
+				}
+				psP->pos--;
+				break;
+			default:
+				psP->pos = Start;
+				return JSMN_ERROR_INVAL;
+			}
+		}
+	}
+	psP->pos = Start;
+	return JSMN_ERROR_PART;
+}
+
+/**
+ * @brief	locate the innermost open (start set, end not) container at or before token Idx
+ * @return	token index or -1 if none
+ */
+static int xJsonTokOpen(jsontok_t * psT0, int Idx) {
+	#if (jsonTOKEN_PARENT == 1)
+	while (Idx >= 0) {
+		jsontok_t * psT = &psT0[Idx];
+		if ((psT->type & (JSMN_OBJECT | JSMN_ARRAY)) && psT->end == jsonTOK_UNSET)
+			return Idx;
+		Idx = (psT->parent == jsonTOK_UNSET) ? -1 : psT->parent;
+	}
+	#else
+	for (; Idx >= 0; --Idx) {
+		if ((psT0[Idx].type & (JSMN_OBJECT | JSMN_ARRAY)) && psT0[Idx].end == jsonTOK_UNSET)
+			return Idx;
+	}
+	#endif
+	return -1;
+}
+
+// ####################################### Global Functions ########################################
+
+int xJsonTokenise(jsmn_parser * psP, const char * pcBuf, size_t szBuf, jsontok_t * psT0, unsigned int NumTok) {
+	if (szBuf > jsonTOK_MAX_LEN)
+		return JSMN_ERROR_INVAL;
+	int iRV;
+	for (; psP->pos < szBuf && pcBuf[psP->pos] != CHR_NUL; psP->pos++) {
+		char cChr = pcBuf[psP->pos];
+		switch (cChr) {
+		case '{':
+		case '[': {
+			jsontok_t * psT = psJsonTokAlloc(psP, psT0, NumTok);
+			if (psT == NULL)
+				return JSMN_ERROR_NOMEM;
+			if (psP->toksuper != -1)
+				psT0[psP->toksuper].size++;
+			vJsonTokFill(psP, psT, (cChr == '{') ? JSMN_OBJECT : JSMN_ARRAY, psP->pos, jsonTOK_UNSET);
+			psP->toksuper = psP->toknext - 1;
+			break;
+		}
+		case '}':
+		case ']': {
+			int Idx = xJsonTokOpen(psT0, (int) psP->toknext - 1);
+			if (Idx < 0 || psT0[Idx].type != ((cChr == '}') ? JSMN_OBJECT : JSMN_ARRAY))
+				return JSMN_ERROR_INVAL;
+			psT0[Idx].end = psP->pos + 1;
+			psP->toksuper = xJsonTokOpen(psT0, Idx - 1);
+			break;
+		}
+		case CHR_DOUBLE_QUOTE:
+			iRV = xJsonTokString(psP, pcBuf, szBuf, psT0, NumTok);
+			if (iRV < 0)
+				return iRV;
+			if (psP->toksuper != -1)
+				psT0[psP->toksuper].size++;
+			break;
+		case '\t': case '\r': case '\n': case ' ':
+			break;
+		case ':':
+			psP->toksuper = psP->toknext - 1;
+			break;
+		case ',':
+			if (psP->toksuper != -1 && (psT0[psP->toksuper].type & (JSMN_OBJECT | JSMN_ARRAY)) == 0) {
+				int Idx = xJsonTokOpen(psT0, psP->toksuper);
+				if (Idx >= 0)
+					psP->toksuper = Idx;				// as jsmn, unchanged if none open
+			}
+			break;
+		default:
+			iRV = xJsonTokPrimitive(psP, pcBuf, szBuf, psT0, NumTok);
+			if (iRV < 0)
+				return iRV;
+			if (psP->toksuper != -1)
+				psT0[psP->toksuper].size++;
+			break;
+		}
+	}
+	for (int i = psP->toknext - 1; i >= 0; --i) {
+		if (psT0[i].start != jsonTOK_UNSET && psT0[i].end == jsonTOK_UNSET)
+			return JSMN_ERROR_PART;
+	}
+	return psP->toknext;
+}
+
+#endif
@@ -0,0 +1,55 @@
+// tokenX.h - token layout used by the parser, jsmn tokens or compact (16 bit) tokens
+
+#pragma once
+
+#define JSMN_HEADER
+#include "jsmn.h"
+#include "complex_vars.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ########################################## macros ###############################################
+
+#ifndef jsonTOKEN_COMPACT
+	#define	jsonTOKEN_COMPACT		0					// 1 = 16 bit offsets, documents < 64KB
+#endif
+
+#ifndef jsonTOKEN_PARENT
+	#define	jsonTOKEN_PARENT		1					// compact tokens include a parent index
+#endif
+
+#define	jsonTOK_UNSET				0xFFFF				// compact token start/end/parent not (yet) set
+#define	jsonTOK_MAX_LEN				0xFFFE				// largest document with compact tokens
+
+// ############################################ structures #########################################
+
+#if (jsonTOKEN_COMPACT == 1)
+typedef struct jsontok_t {								// 8 bytes, 10 with parent
+	u16_t start;
+	u16_t end;
+	u16_t size;
+	u8_t type;											// jsmntype_t
+	u8_t spare;
+	#if (jsonTOKEN_PARENT == 1)
+	u16_t parent;										// jsonTOK_UNSET if none
+	#endif
+} jsontok_t;
+#else
+typedef jsmntok_t jsontok_t;
+#endif
+
+// ####################################### global functions ########################################
+
+#if (jsonTOKEN_COMPACT == 1)
+/**
+ * @brief	jsmn_parse() equivalent (non strict, resumable) producing compact tokens
+ * @return	number of tokens or JSMN_ERROR_xxx, JSMN_ERROR_INVAL if the document is too large
+ */
+int xJsonTokenise(jsmn_parser * psP, const char * pcBuf, size_t szBuf, jsontok_t * psT0, unsigned int NumTok);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
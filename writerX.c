@@ -11,20 +11,31 @@
  *
  * Start a new OPEN:
  * 	object		Always start and leave open, cannot allow writing a complete object in 1 step...
- * 	array		Do we need now, can we stick to force adding an array in 1 go?
+ * 	array		ecJsonOpenArray() / ecJsonCloseArray(), at any depth, in an object or another array
  *
  * Logical flow sequence:
  *	MUST start with ecJsonCreateObject() to create root/[grand]parent object
+ *		or ecJsonCreateObjectCtx() to write via a json_ctx_t output context, which can
+ *		measure only (vJsonCtxMeasure), chain overflow segments beyond the ubuf_t (vJsonCtxInit)
+ *		or stream through the ubuf_t to a sink callback (vJsonCtxSink)
  *	Then using ecJsonAddKeyValue() can add { key:value [, key:value ..] } pairs
  *		Any key:value of type ARRAY added MUST be a complete item,
  *			and the array members MUST be of same type, STRING or NUMBER, only
  *		If the key:value type is OBJECT ecJsonAddKeyValue() will create a new OPEN child object
+ *	Open arrays take values (key = NULL), objects or further open arrays, 1 element at a time
  *
  * Current restrictions:
- * 	No ARRAY within another ARRAY (ie nesting) catered for.
- *	Currently support string only and numbers only arrays, not mixed or other
- *	Ad hoc opening & closing of arrays not yet supported
- *	\uxxxx (four hex digits) not yet escaped...
+ *	Complete (1 step) arrays support string only and numbers only members, not mixed or other
+ *	Only 1 child (object or array) of a parent can be open at a time
+ *
+ * String escapes:
+ *	" \ / and \b \f \n \r \t written as 2 character escapes, other control characters as \u00XX
+ *	All other characters, including UTF-8 sequences, copied as is
+ *
+ * CBOR output (json_ctx_t Format = jsonFMT_CBOR):
+ *	Same calls, objects & open arrays written as indefinite length map/array, 1 step arrays with
+ *	definite length, integers in shortest form, floats as float32/float64, strings not escaped.
+ *	Decimals setting and timestamps not applicable.
  */
 
 #include "hal_platform.h"
@@ -33,6 +44,9 @@
 #include "options.h"
 #include "syslog.h"
 #include "string_general.h"
+#include "swarX.h"
+#include "cborX.h"
+#include "statsX.h"
 
 #include <string.h>
 
@@ -43,33 +57,225 @@
 #define	debugPARAM					(debugFLAG_GLOBAL & debugFLAG & 0x4000)
 #define	debugRESULT					(debugFLAG_GLOBAL & debugFLAG & 0x8000)
 
-static int	ecJsonDecimals = xpfDEFAULT_DECIMALS;
-static const char ESChars[] = { '\\', '"', '/', '\b', '\f', '\t', '\n', '\r', '\0' };
+#define	jsonBATCH_SIZE				256					// local formatting buffer for number arrays
+#define	jsonTIME_BUF_SIZE			64					// local formatting buffer for timestamps
+
+#define	jsonIS_CBOR(pJ)				((pJ)->psCtx && (pJ)->psCtx->Format == jsonFMT_CBOR)
+
+static int	ecJsonDecimals = jsonDECIMALS_DEFAULT;
+
+// Escape classification, 0 = copy as is, 'u' = \u00XX else character following the '\'
+static const char ESClass[256] = {
+	'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+	'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+	[CHR_DOUBLE_QUOTE] = CHR_DOUBLE_QUOTE, ['/'] = '/', [CHR_BACKSLASH] = CHR_BACKSLASH,
+};
+static const char HexChars[] = "0123456789abcdef";
+
+/**
+ * @brief		pass a block to the sink, repeating until all bytes accepted
+ * @note		a sink accepting 0 (no progress) or returning < 0 is an error, output marked truncated
+ */
+static void ecJsonSinkAll(json_ctx_t * psCtx, const char * pcBuf, size_t szBuf) {
+	while (szBuf && psCtx->fFull == 0) {
+		int iRV = psCtx->hdlrSink(psCtx->pvSink, pcBuf, szBuf);
+		if (iRV <= 0 || (size_t) iRV > szBuf) {
+			psCtx->fFull = 1;
+			break;
+		}
+		pcBuf += iRV;
+		szBuf -= iRV;
+	}
+}
+
+int ecJsonCtxFlush(json_ctx_t * psCtx) {
+	if (psCtx->hdlrSink && psCtx->psUB) {
+		size_t szUsed = xUBufGetUsed(psCtx->psUB);
+		if (szUsed)
+			ecJsonSinkAll(psCtx, psCtx->psUB->pBuf, szUsed);
+		vUBufReset(psCtx->psUB);
+	}
+	return psCtx->fFull ? erJSON_BUF_FULL : erSUCCESS;
+}
+
+/**
+ * @brief		write a block of characters via the buffer to the sink, flushing at the high water mark
+ */
+static void ecJsonSinkWrite(json_ctx_t * psCtx, const char * pcBuf, size_t szBuf) {
+	ubuf_t * psUB = psCtx->psUB;
+	if (psUB == NULL) {									// unbuffered, straight to the sink
+		ecJsonSinkAll(psCtx, pcBuf, szBuf);
+		return;
+	}
+	size_t HighWater = psCtx->HighWater ? psCtx->HighWater : psUB->Size;
+	if (szBuf >= HighWater) {							// large block, flush then pass on as is
+		ecJsonCtxFlush(psCtx);
+		ecJsonSinkAll(psCtx, pcBuf, szBuf);
+		return;
+	}
+	while (szBuf && psCtx->fFull == 0) {
+		size_t szNow = xUBufGetSpace(psUB);
+		if (szNow > szBuf)
+			szNow = szBuf;
+		memcpy(pcUBufTellWrite(psUB), pcBuf, szNow);
+		vUBufStepWrite(psUB, szNow);
+		pcBuf += szNow;
+		szBuf -= szNow;
+		if ((size_t) xUBufGetUsed(psUB) >= HighWater || xUBufGetSpace(psUB) == 0)
+			ecJsonCtxFlush(psCtx);
+	}
+}
+
+/**
+ * @brief		write a block of characters via an output context, measure or buffer & chain
+ */
+static void ecJsonCtxWrite(json_ctx_t * psCtx, const char * pcBuf, size_t szBuf) {
+	psCtx->Count += szBuf;
+	if (psCtx->fMeasure)
+		return;
+	if (psCtx->hdlrSink) {
+		ecJsonSinkWrite(psCtx, pcBuf, szBuf);
+		return;
+	}
+	if (psCtx->psTail == NULL) {						// still writing to the buffer
+		size_t szNow = xUBufGetSpace(psCtx->psUB);
+		if (szNow > szBuf)
+			szNow = szBuf;
+		memcpy(pcUBufTellWrite(psCtx->psUB), pcBuf, szNow);
+		vUBufStepWrite(psCtx->psUB, szNow);
+		pcBuf += szNow;
+		szBuf -= szNow;
+	}
+	while (szBuf) {										// overflow, continue in chained segment(s)
+		json_seg_t * psSeg = psCtx->psTail;
+		if (psSeg == NULL || psSeg->Used == psSeg->Size) {
+			size_t szNew = (szBuf > psCtx->szSeg) ? szBuf : psCtx->szSeg;
+			psSeg = psCtx->szSeg ? (json_seg_t *) malloc(sizeof(json_seg_t) + szNew) : NULL;
+			if (psSeg == NULL) {
+				psCtx->Count -= szBuf;
+				psCtx->fFull = 1;
+				return;
+			}
+			psSeg->psNext = NULL;
+			psSeg->Used = 0;
+			psSeg->Size = szNew;
+			if (psCtx->psTail)
+				psCtx->psTail->psNext = psSeg;
+			else
+				psCtx->psHead = psSeg;
+			psCtx->psTail = psSeg;
+		}
+		size_t szNow = psSeg->Size - psSeg->Used;
+		if (szNow > szBuf)
+			szNow = szBuf;
+		memcpy(psSeg->Buf + psSeg->Used, pcBuf, szNow);
+		psSeg->Used += szNow;
+		pcBuf += szNow;
+		szBuf -= szNow;
+	}
+}
+
+/**
+ * @brief		write a block of characters to the stream, single space check for the block
+ * @param[in]	pJson - pointer to control structure
+ * @param[in]	pcBuf - characters to be added, copied as is
+ * @param[in]	szBuf - number of characters
+ */
+static void ecJsonWrite(json_obj_t * pJson, const char * pcBuf, size_t szBuf) {
+	jsonSTAT_ADD(WriteBytes, szBuf);
+	jsonSTAT_DOC(pJson, StatBytes, szBuf);
+	if (pJson->psCtx) {
+		ecJsonCtxWrite(pJson->psCtx, pcBuf, szBuf);
+		return;
+	}
+	ubuf_t * psUB = pJson->psUB;
+	size_t szSpace = xUBufGetSpace(psUB);
+	if (szBuf > szSpace) {
+		szBuf = szSpace;
+		pJson->f_Full = 1;
+	}
+	memcpy(pcUBufTellWrite(psUB), pcBuf, szBuf);
+	vUBufStepWrite(psUB, szBuf);
+}
+
+int ecJsonStatus(json_obj_t * pJson) {
+	int fFull = pJson->psCtx ? pJson->psCtx->fFull : pJson->f_Full;
+	return fFull ? erJSON_BUF_FULL : erSUCCESS;
+}
 
 /**
  * @brief		write a single char to the stream
  * @param[in]	pJson - pointer to control structure
  * @param[in]	cChar - character to be added
- * @return		number of characters added or erFAILURE
  */
-static void ecJsonAddChar(json_obj_t * pJson, char cChar) {
-	uprintfx(pJson->psUB, "%c", cChar);
-	IF_myASSERT(debugRESULT, xUBufGetSpace(pJson->psUB) > 0);
+static void ecJsonAddChar(json_obj_t * pJson, char cChar) { ecJsonWrite(pJson, &cChar, 1); }
+
+/**
+ * @brief		write a structural mark, JSON character or CBOR initial byte
+ */
+static void ecJsonAddMark(json_obj_t * pJson, char cJson, u8_t u8Cbor) {
+	ecJsonAddChar(pJson, jsonIS_CBOR(pJson) ? (char) u8Cbor : cJson);
+}
+
+/**
+ * @brief		write a CBOR item head
+ */
+static void ecCborAddHead(json_obj_t * pJson, int Major, u64_t Val) {
+	u8_t u8Buf[cborHEAD_SIZE];
+	ecJsonWrite(pJson, (char *) u8Buf, xCborFormatHead(u8Buf, Major, Val));
+}
+
+/**
+ * @brief		find the next character requiring an escape
+ * @return		offset of character or Sz if none
+ */
+static size_t xJsonScanEscape(const char * pStr, size_t Sz) {
+	size_t Idx = 0;
+	#if (swarSSE2 == 1)
+	const __m128i xQuote = _mm_set1_epi8(CHR_DOUBLE_QUOTE), xSlash = _mm_set1_epi8('/');
+	const __m128i xBSlash = _mm_set1_epi8(CHR_BACKSLASH), xCtrl = _mm_set1_epi8(0x1F);
+	for (; (Idx + 16) <= Sz; Idx += 16) {
+		__m128i xChr = _mm_loadu_si128((const __m128i *) (pStr + Idx));
+		__m128i xHit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(xChr, xQuote), _mm_cmpeq_epi8(xChr, xSlash)),
+						_mm_or_si128(_mm_cmpeq_epi8(xChr, xBSlash), _mm_cmpeq_epi8(_mm_max_epu8(xChr, xCtrl), xCtrl)));
+		int Mask = _mm_movemask_epi8(xHit);
+		if (Mask)
+			return Idx + __builtin_ctz(Mask);
+	}
+	#endif
+	for (; (Idx + 8) <= Sz; Idx += 8) {				// 8 at a time, stop at first block with a hit
+		uint64_t u64 = swarLoad(pStr + Idx);
+		if (swarHAS_LESS(u64, 0x20) | swarHAS_BYTE(u64, CHR_DOUBLE_QUOTE) | swarHAS_BYTE(u64, '/') | swarHAS_BYTE(u64, CHR_BACKSLASH))
+			break;
+	}
+	for (; Idx < Sz; ++Idx) {							// locate exact position (or handle tail)
+		if (ESClass[(u8_t) pStr[Idx]])
+			break;
+	}
+	return Idx;
 }
 
 /**
  * @brief		write corrected escaped string to the stream
  * @param[in]	pJson - pointer to control structure
  * @param[in]	pStr - characters to be added
- * @return		number of characters added or erFAILURE
+ * @param[in]	Sz - number of characters, 0 if NUL terminated
  */
 static void ecJsonAddChars(json_obj_t * pJson, const char * pStr, size_t Sz) {
 	if (Sz == 0)										// Step 1: determine the string length
 		Sz = strlen(pStr);
-	while (Sz--) {										// Step 2: handle characters (with optional escapes)
-		if (strchr(ESChars, *pStr))
-			ecJsonAddChar(pJson, CHR_BACKSLASH);
-		ecJsonAddChar(pJson, *pStr++);
+	while (Sz) {										// Step 2: copy runs of characters between escapes
+		size_t Run = xJsonScanEscape(pStr, Sz);
+		ecJsonWrite(pJson, pStr, Run);
+		if (Run == Sz)
+			break;
+		u8_t cChr = pStr[Run];
+		char caEsc[6] = { CHR_BACKSLASH, ESClass[cChr], '0', '0', HexChars[cChr >> 4], HexChars[cChr & 0x0F] };
+		jsonSTAT_ADD(WriteEscapes, 1);
+		jsonSTAT_DOC(pJson, StatEscapes, 1);
+		ecJsonWrite(pJson, caEsc, (caEsc[1] == 'u') ? 6 : 2);
+		pStr += Run + 1;
+		Sz -= Run + 1;
 	}
 }
 
@@ -80,6 +286,13 @@ static void ecJsonAddChars(json_obj_t * pJson, const char * pStr, size_t Sz) {
  * @return
  */
 static void ecJsonAddString(json_obj_t * pJson, const char * pStr, size_t Sz) {
+	if (jsonIS_CBOR(pJson)) {							// text string, length prefixed, no escapes
+		if (Sz == 0)
+			Sz = strlen(pStr);
+		ecCborAddHead(pJson, cborMAJOR_TSTR, Sz);
+		ecJsonWrite(pJson, pStr, Sz);
+		return;
+	}
 	ecJsonAddChar(pJson, CHR_DOUBLE_QUOTE);				// Step 1: write the opening ' " '
 	ecJsonAddChars(pJson, pStr, Sz);					// Step 2: write the string
 	ecJsonAddChar(pJson, CHR_DOUBLE_QUOTE);				// Step 3: write the closing ' " '
@@ -88,17 +301,70 @@ static void ecJsonAddString(json_obj_t * pJson, const char * pStr, size_t Sz) {
 /**
  * @brief	add and array of strings to the stream
  * @param	pJson
- * @param	pValue
+ * @param	pValue - array of string pointers or, if Stride != 0, the first of the inline strings
  * @param	xSize
+ * @param	Stride - 0 for an array of pointers, else distance between inline (char array) strings
  * @return
  */
-static void ecJsonAddArrayStrings(json_obj_t * pJson, px_t pX, size_t Sz) {
-	ecJsonAddChar(pJson, CHR_L_SQUARE);					// Step 1: write the opening ' [ '
+static void ecJsonAddArrayStrings(json_obj_t * pJson, px_t pX, size_t Sz, size_t Stride) {
+	int fCbor = jsonIS_CBOR(pJson);
+	if (fCbor)
+		ecCborAddHead(pJson, cborMAJOR_ARRAY, Sz);		// Step 1: write the array head (CBOR)
+	else
+		ecJsonAddChar(pJson, CHR_L_SQUARE);				//		or the opening ' [ '
 	while (Sz--) {										// Step 2: handle each string from array, 1 by 1
-		ecJsonAddString(pJson, *pX.ppc8++, 0);			// Step 2a: add the string
-		if (Sz != 0) ecJsonAddChar(pJson, CHR_COMMA);
+		if (Stride) {
+			ecJsonPutStr(pJson, pX.pc8);				// Step 2a: add the string
+			pX.pv += Stride;
+		} else {
+			ecJsonPutStr(pJson, *pX.ppc8++);
+		}
+		if (Sz != 0 && !fCbor) ecJsonAddChar(pJson, CHR_COMMA);
+	}
+	if (!fCbor)
+		ecJsonAddChar(pJson, CHR_R_SQUARE);				// Step 3: write the closing ' ] '
+}
+
+/**
+ * @brief		format a number, using the correct format for the type
+ * @param[out]	pcBuf - buffer of at least jsonNUM_BUF_SIZE characters
+ * @return		number of characters written
+ */
+static int xJsonFormatNumber(char * pcBuf, px_t pX, cvi_e cvI, int Decimals) {
+	switch(cvI) {
+	case cvU08:	return xJsonFormatU64(pcBuf, *pX.pu8);
+	case cvU16:	return xJsonFormatU64(pcBuf, *pX.pu16);
+	case cvU32:	return xJsonFormatU64(pcBuf, *pX.pu32);
+	case cvU64:	return xJsonFormatU64(pcBuf, *pX.pu64);
+	case cvI08:	return xJsonFormatI64(pcBuf, *pX.pi8);
+	case cvI16:	return xJsonFormatI64(pcBuf, *pX.pi16);
+	case cvI32:	return xJsonFormatI64(pcBuf, *pX.pi32);
+	case cvI64:	return xJsonFormatI64(pcBuf, *pX.pi64);
+	case cvF32:	return xJsonFormatF32(pcBuf, *pX.pf32, Decimals);
+	case cvF64:	return xJsonFormatF64(pcBuf, *pX.pf64, Decimals);
+	default: IF_myASSERT(debugTRACK, 0); return 0;
+	}
+}
+
+/**
+ * @brief		encode a number as CBOR, using the correct format for the type
+ * @param[out]	pu8Buf - buffer of at least cborHEAD_SIZE bytes
+ * @return		number of bytes written
+ */
+static int xCborFormatNumber(u8_t * pu8Buf, px_t pX, cvi_e cvI) {
+	switch(cvI) {
+	case cvU08:	return xCborFormatU64(pu8Buf, *pX.pu8);
+	case cvU16:	return xCborFormatU64(pu8Buf, *pX.pu16);
+	case cvU32:	return xCborFormatU64(pu8Buf, *pX.pu32);
+	case cvU64:	return xCborFormatU64(pu8Buf, *pX.pu64);
+	case cvI08:	return xCborFormatI64(pu8Buf, *pX.pi8);
+	case cvI16:	return xCborFormatI64(pu8Buf, *pX.pi16);
+	case cvI32:	return xCborFormatI64(pu8Buf, *pX.pi32);
+	case cvI64:	return xCborFormatI64(pu8Buf, *pX.pi64);
+	case cvF32:	return xCborFormatF32(pu8Buf, *pX.pf32);
+	case cvF64:	return xCborFormatF64(pu8Buf, *pX.pf64);
+	default: IF_myASSERT(debugTRACK, 0); return 0;
 	}
-	ecJsonAddChar(pJson, CHR_R_SQUARE);					// Step 3: write the closing ' ] '
 }
 
 /**
@@ -109,23 +375,9 @@ static void ecJsonAddArrayStrings(json_obj_t * pJson, px_t pX, size_t Sz) {
  * @return
  */
 static void ecJsonAddNumber(json_obj_t * pJson, px_t pX, cvi_e cvI) {
-	x64_t X64;
-	switch(cvI) {										// Normalize size to X64
-	case cvU08:	X64.u64	= *pX.pu8; break;
-	case cvU16:	X64.u64	= *pX.pu16; break;
-	case cvU32:	X64.u64	= *pX.pu32; break;
-	case cvU64:	X64.u64	= *pX.pu64; break;
-	case cvI08:	X64.i64	= *pX.pi8; break;
-	case cvI16:	X64.i64	= *pX.pi16; break;
-	case cvI32:	X64.i64	= *pX.pi32; break;
-	case cvI64:	X64.i64	= *pX.pi64; break;
-	case cvF32:	X64.f64	= *pX.pf32; break;
-	case cvF64:	X64.f64	= *pX.pf64; break;
-	default: IF_myASSERT(debugTRACK, 0); return;
-	}
-	// Step 2: write the value, format depending on fractional part
-	uprintfx(pJson->psUB, cvI < cvI08 ? "%llu" : cvI < cvF32 ? "%lld" : "%g" , X64.f64);
-	IF_myASSERT(debugRESULT, xUBufGetSpace(pJson->psUB) > 0);
+	char caBuf[jsonNUM_BUF_SIZE];
+	int Len = jsonIS_CBOR(pJson) ? xCborFormatNumber((u8_t *) caBuf, pX, cvI) : xJsonFormatNumber(caBuf, pX, cvI, pJson->Decimals);
+	ecJsonWrite(pJson, caBuf, Len);
 }
 
 /**
@@ -133,59 +385,111 @@ static void ecJsonAddNumber(json_obj_t * pJson, px_t pX, cvi_e cvI) {
  * @brief	Assume the members of the array are all there and ready to be added.
  * @brief	Will open, fill and close the array, with a leading COMMA is other values
  * @brief	already in the object..
+ * @note	values are formatted into a local batch, written to the stream when (nearly) full
  */
-static void ecJsonAddArrayNumbers(json_obj_t * pJson, px_t pX, cvi_e cvI, size_t Sz) {
-	ecJsonAddChar(pJson, CHR_L_SQUARE);				// Step 1: write the opening ' [ '
-	while (Sz--) {									// Step 2: handle each array value, 1 by 1
-		ecJsonAddNumber(pJson, pX, cvI);			// Step 2a: add the number & optional comma separator
-		if (Sz != 0) ecJsonAddChar(pJson, CHR_COMMA);
-		pX.pv += xIndex2Bytes(cvI);					// Step 3: adjust the source value address
+static void ecJsonAddArrayNumbers(json_obj_t * pJson, px_t pX, cvi_e cvI, size_t Sz, size_t Stride) {
+	char caBuf[jsonBATCH_SIZE];
+	size_t Step = Stride ? Stride : xIndex2Bytes(cvI);
+	int Len = 0;
+	if (jsonIS_CBOR(pJson)) {							// definite length array, no separators
+		Len = xCborFormatHead((u8_t *) caBuf, cborMAJOR_ARRAY, Sz);
+		while (Sz--) {
+			if (Len > (int) (sizeof(caBuf) - cborHEAD_SIZE)) {
+				ecJsonWrite(pJson, caBuf, Len);
+				Len = 0;
+			}
+			Len += xCborFormatNumber((u8_t *) caBuf + Len, pX, cvI);
+			pX.pv += Step;
+		}
+		ecJsonWrite(pJson, caBuf, Len);
+		return;
+	}
+	caBuf[Len++] = CHR_L_SQUARE;						// Step 1: write the opening ' [ '
+	while (Sz--) {										// Step 2: handle each array value, 1 by 1
+		if (Len > (int) (sizeof(caBuf) - jsonNUM_BUF_SIZE - 2)) {
+			ecJsonWrite(pJson, caBuf, Len);
+			Len = 0;
+		}
+		Len += xJsonFormatNumber(caBuf + Len, pX, cvI, pJson->Decimals);	// Step 2a: add the number & optional comma separator
+		if (Sz != 0) caBuf[Len++] = CHR_COMMA;
+		pX.pv += Step;									// Step 3: adjust the source value address
 	}
-	ecJsonAddChar(pJson, CHR_R_SQUARE);				// Step 4: write the closing ' ] '
+	caBuf[Len++] = CHR_R_SQUARE;						// Step 4: write the closing ' ] '
+	ecJsonWrite(pJson, caBuf, Len);
 }
 
-static json_obj_t * ecJsonAddObject(json_obj_t * pJson, px_t pX) {
-	json_obj_t * pJson1	= (json_obj_t *) pX.pv;
-	ecJsonCreateObject(pJson1, pJson->psUB); 			// create new object with same buffer
+/**
+ * @brief		write the separator, if not the first value, and the key (if supplied) for a value to follow
+ * @param[in]	pKey - key, NULL if array element
+ * @param[in]	szKey - length of key, 0 if NUL terminated
+ */
+static void ecJsonAddKey(json_obj_t * pJson, const char * pKey, size_t szKey) {
+	int fCbor = jsonIS_CBOR(pJson);
+	if (pJson->val_count > 0 && !fCbor)
+		ecJsonAddChar(pJson, CHR_COMMA);
+	if (pKey != 0) {
+		ecJsonAddString(pJson, pKey, szKey);
+		if (!fCbor)
+			ecJsonAddChar(pJson, CHR_COLON);
+	}
+}
+
+static void ecJsonOpen(json_obj_t * pJson, ubuf_t * psUB, json_ctx_t * psCtx, u8_t Type);
+
+static json_obj_t * ecJsonAddChild(json_obj_t * pJson, json_obj_t * pJson1, u8_t Type) {
+	IF_myASSERT(debugPARAM, pJson->child == NULL);		// previous child MUST be closed
+	ecJsonOpen(pJson1, pJson->psUB, pJson->psCtx, Type);	// create new object/array with same buffer/context
+	pJson1->Decimals = pJson->Decimals;					// inherit configuration
+	pJson1->f_Trace = pJson->f_Trace;
 	pJson->child = pJson1;								// setup link from parent to child
 	pJson1->parent = pJson;								// setup link from child to parent
-	pJson->obj_nest++;									// increase parent nest level
+	if (Type == jsonTYPE_LIST)
+		pJson->arr_nest++;								// increase parent nest level
+	else
+		pJson->obj_nest++;
 	return pJson1;
 }
 
+static json_obj_t * ecJsonAddObject(json_obj_t * pJson, px_t pX) {
+	return ecJsonAddChild(pJson, (json_obj_t *) pX.pv, jsonTYPE_NULL);
+}
+
 static json_obj_t * ecJsonAddArrayObject(json_obj_t * pJson, px_t pX) {
 	IF_myASSERT(debugPARAM, halMemorySRAM(pX.pv));	// MUST be in SRAM
-	ecJsonAddChar(pJson, CHR_L_SQUARE);					// Step 1: write the opening '['
+	ecJsonAddMark(pJson, CHR_L_SQUARE, cborARRAY_INDEF);	// Step 1: write the opening '['
 	return ecJsonAddObject(pJson, pX);					// Step 2: create the object '{'
 }
 
 #if	(jsonHAS_TIMESTAMP == 1)
 /**
- * @brief
+ * @brief	format a timestamp locally then write it as a string, via the context (if any) like all values
  * @param pJson		- JSON structure on which to operate
  * @param pValue	- pointer to the TSZ structure to use
- * @param eFormType	- format in which to write the timestamp
- * @return
+ * @param cvI		- format in which to write the timestamp
  */
 static void ecJsonAddTimeStamp(json_obj_t * pJson, px_t pValue, cvi_e cvI) {
+	char caBuf[jsonTIME_BUF_SIZE];
+	ubuf_t sUB = { .pBuf = caBuf, .Size = sizeof(caBuf) - 1 };	// space for NUL
 	switch(cvI) {
-	case cvDT_ELAP: uprintfx(pJson->psUB, "\"%!R\"", *pValue.pu64);	break;
-	case cvDT_UTC: uprintfx(pJson->psUB, "\"%R\"", *pValue.pu64);	break;
-	case cvDT_ALT: uprintfx(pJson->psUB, "\"%#Z\"", pValue.pv);	break;
-	case cvDT_TZ: uprintfx(pJson->psUB, "\"%+Z\"", pValue.pv);	break;
-	default: IF_myASSERT(debugPARAM, 0); 			return;
+	case cvDT_ELAP: uprintfx(&sUB, "%!R", *pValue.pu64);	break;
+	case cvDT_UTC: uprintfx(&sUB, "%R", *pValue.pu64);		break;
+	case cvDT_ALT: uprintfx(&sUB, "%#Z", pValue.pv);		break;
+	case cvDT_TZ: uprintfx(&sUB, "%+Z", pValue.pv);			break;
+	default: IF_myASSERT(debugPARAM, 0); 					return;
 	}
-	IF_myASSERT(debugRESULT, xUBufGetSpace(pJson->psUB) > 0);
+	caBuf[xUBufGetUsed(&sUB)] = CHR_NUL;				// empty is "" not strlen() of garbage
+	ecJsonAddString(pJson, caBuf, 0);
 }
 #endif
 
 /**
  * ecJsonSetDecimals()	Set the number of decimals to display
- * @brief Set the number of default float digits, if invalid parameter reset to default
- * @param xNumber		Number of digits to set
- * @return				erSUCCESS if xNumber in range, else erFAILURE
+ * @brief Set the number of fixed float decimals, if invalid parameter reset to default
+ * @param xNumber		Number of decimals to set, jsonDECIMALS_SHORTEST for shortest round trip
  */
-void ecJsonSetDecimals(int xNumber) { ecJsonDecimals = INRANGE(0, xNumber, xpfMAXIMUM_DECIMALS) ? xNumber : xpfDEFAULT_DECIMALS; }
+void ecJsonSetDecimals(int xNumber) { ecJsonDecimals = xJsonDecimals(xNumber); }
+
+void ecJsonSetDecimalsObj(json_obj_t * pJson, int xNumber) { pJson->Decimals = xJsonDecimals(xNumber); }
 
 /**
  * ecJsonAddKeyValue() - add a key : value[number array] pair
@@ -201,20 +505,17 @@ void ecJsonSetDecimals(int xNumber) { ecJsonDecimals = INRANGE(0, xNumber, xpfMA
  * 			of the the new Json object struct to be filled in....
  */
 int	ecJsonAddKeyValue(json_obj_t * pJson, const char * pKey, px_t pX, jform_t jForm, cvi_e cvI, size_t Sz) {
-	u8_t Option = OPT_GET(dbgJSONwr);
-	IF_PX(debugTRACK && Option, "p1=%p  p2=%s  p3=%p  p4=%hhu  p5=%hhu  p6=%zu", (void *)pJson, pKey, pX.pv, jForm, cvI, Sz);
-	IF_myASSERT(debugPARAM, halMemorySRAM(pJson) && halMemorySRAM(pJson->psUB) && halMemoryANY(pX.pv));
+	jsonSTAT_T0(T0);
+	IF_PX(debugTRACK && pJson->f_Trace, "p1=%p  p2=%s  p3=%p  p4=%hhu  p5=%hhu  p6=%zu", (void *)pJson, pKey, pX.pv, jForm, cvI, Sz);
+	IF_myASSERT(debugPARAM, halMemorySRAM(pJson) && (pJson->psCtx || halMemorySRAM(pJson->psUB)) && halMemoryANY(pX.pv));
 
-	if (pJson->val_count > 0)
-		ecJsonAddChar(pJson, CHR_COMMA);
-	if (pKey != 0) {									// Step 2: If key supplied
-		ecJsonAddString(pJson, pKey, 0);				//			add it...
-		ecJsonAddChar(pJson, CHR_COLON);
-	}
+	IF_myASSERT(debugPARAM, pJson->child == NULL && (pJson->type != jsonTYPE_LIST || pKey == NULL));
+	ecJsonAddKey(pJson, (pJson->type == jsonTYPE_LIST) ? NULL : pKey, 0);	// Step 2: separator & key
+	int fCbor = jsonIS_CBOR(pJson);
 	switch(jForm) {										// Step 3: Add the value
-	case jsonNULL: ecJsonAddChars(pJson, "null", sizeof("null") - 1); break;
-	case jsonFALSE: ecJsonAddChars(pJson, "false", sizeof("false") - 1); break;
-	case jsonTRUE: ecJsonAddChars(pJson, "true", sizeof("true") - 1); break;
+	case jsonNULL: fCbor ? ecJsonAddChar(pJson, cborNULL) : ecJsonWrite(pJson, "null", sizeof("null") - 1); break;
+	case jsonFALSE: fCbor ? ecJsonAddChar(pJson, cborFALSE) : ecJsonWrite(pJson, "false", sizeof("false") - 1); break;
+	case jsonTRUE: fCbor ? ecJsonAddChar(pJson, cborTRUE) : ecJsonWrite(pJson, "true", sizeof("true") - 1); break;
 	case jsonXXX: ecJsonAddNumber(pJson, pX, cvI); break;			// Sz ignored
 	case jsonSXX: ecJsonAddString(pJson, pX.pc8, Sz); break;
 	#if	(jsonHAS_TIMESTAMP == 1)
@@ -225,18 +526,107 @@ int	ecJsonAddKeyValue(json_obj_t * pJson, const char * pKey, px_t pX, jform_t jF
 			ecJsonAddArrayObject(pJson, pX)->type = jsonTYPE_ARRAY;	// Sz ignored
 		} else {
 			IF_myASSERT(debugPARAM, Sz > 0);
-			if (cvI <= cvSXX)		ecJsonAddArrayNumbers(pJson, pX, cvI, Sz);
-			else if (cvI == cvSXX)	ecJsonAddArrayStrings(pJson, pX, Sz);
+			if (cvI < cvSXX)		ecJsonAddArrayNumbers(pJson, pX, cvI, Sz, 0);
+			else if (cvI == cvSXX)	ecJsonAddArrayStrings(pJson, pX, Sz, 0);
 			else					return erJSON_ARRAY;
 		}
 		break;
 	case jsonOBJ: ecJsonAddObject(pJson, pX); break;
 	default: IF_myASSERT(debugRESULT, 0); return erJSON_TYPE;
 	}
-	if (jForm != jsonOBJ)
+	pJson->val_count++;									// child objects count as values too
+	IF_PX(debugTRACK && pJson->f_Trace && pJson->psUB, "%.*s", (int) pJson->psUB->Used, pJson->psUB->pBuf);
+	jsonSTAT_HIST(AddKV, T0);
+	return ecJsonStatus(pJson);
+}
+
+/**
+ * @brief		add a key : [column] pair, values taken at a fixed stride, eg 1 member from an array of structs
+ * @param[in]	pKey - key, escaped as required
+ * @param[in]	pX - address of the first value
+ * @param[in]	cvI - cvU08 -> cvF64 or cvSXX (inline char array)
+ * @param[in]	Sz - number of values
+ * @param[in]	Stride - distance in bytes between successive values
+ * @return		erSUCCESS, erJSON_BUF_FULL or erJSON_ARRAY
+ */
+int ecJsonAddKeyColumn(json_obj_t * pJson, const char * pKey, px_t pX, cvi_e cvI, size_t Sz, size_t Stride) {
+	IF_myASSERT(debugPARAM, halMemorySRAM(pJson) && pJson->type != jsonTYPE_LIST && Stride > 0);
+	if (cvI > cvSXX)
+		return erJSON_ARRAY;
+	ecJsonAddKey(pJson, pKey, 0);						// separator & escaped key
+	pJson->val_count++;
+	if (cvI == cvSXX)
+		ecJsonAddArrayStrings(pJson, pX, Sz, Stride);
+	else
+		ecJsonAddArrayNumbers(pJson, pX, cvI, Sz, Stride);
+	return ecJsonStatus(pJson);
+}
+
+/**
+ * @brief		write a key, with separator if required, for a value to follow using ecJsonPutXXX()
+ * @param[in]	pcKey - key, used as is, NO escaping (intended for compile time names)
+ * @param[in]	szKey - length of key
+ */
+void ecJsonPutKey(json_obj_t * pJson, const char * pcKey, size_t szKey) {
+	char caBuf[64];
+	int Len = 0;
+	if (jsonIS_CBOR(pJson)) {
+		ecJsonAddKey(pJson, pcKey, szKey);
 		pJson->val_count++;
-	IF_PX(debugTRACK && Option, "%.*s", pJson->psUB->Used, pJson->psUB->pBuf);
-	return erSUCCESS;
+		return;
+	}
+	if (pJson->val_count++ > 0)
+		caBuf[Len++] = CHR_COMMA;
+	if ((szKey + 4) > sizeof(caBuf)) {					// unusually long key, write as is
+		ecJsonWrite(pJson, caBuf, Len);
+		ecJsonAddString(pJson, pcKey, szKey);
+		ecJsonAddChar(pJson, CHR_COLON);
+		return;
+	}
+	caBuf[Len++] = CHR_DOUBLE_QUOTE;
+	memcpy(caBuf + Len, pcKey, szKey);
+	Len += szKey;
+	caBuf[Len++] = CHR_DOUBLE_QUOTE;
+	caBuf[Len++] = CHR_COLON;
+	ecJsonWrite(pJson, caBuf, Len);
+}
+
+/**
+ * @brief		write the separator, if required, for an array element to follow using ecJsonPutXXX()
+ */
+void ecJsonPutItem(json_obj_t * pArr) {
+	IF_myASSERT(debugPARAM, pArr->type == jsonTYPE_LIST);
+	ecJsonAddKey(pArr, NULL, 0);
+	pArr->val_count++;
+}
+
+void ecJsonPutU64(json_obj_t * pJson, u64_t U64) {
+	char caBuf[jsonNUM_BUF_SIZE];
+	ecJsonWrite(pJson, caBuf, jsonIS_CBOR(pJson) ? xCborFormatU64((u8_t *) caBuf, U64) : xJsonFormatU64(caBuf, U64));
+}
+
+void ecJsonPutI64(json_obj_t * pJson, i64_t I64) {
+	char caBuf[jsonNUM_BUF_SIZE];
+	ecJsonWrite(pJson, caBuf, jsonIS_CBOR(pJson) ? xCborFormatI64((u8_t *) caBuf, I64) : xJsonFormatI64(caBuf, I64));
+}
+
+void ecJsonPutF32(json_obj_t * pJson, f32_t F32) {
+	char caBuf[jsonNUM_BUF_SIZE];
+	ecJsonWrite(pJson, caBuf, jsonIS_CBOR(pJson) ? xCborFormatF32((u8_t *) caBuf, F32) : xJsonFormatF32(caBuf, F32, pJson->Decimals));
+}
+
+void ecJsonPutF64(json_obj_t * pJson, f64_t F64) {
+	char caBuf[jsonNUM_BUF_SIZE];
+	ecJsonWrite(pJson, caBuf, jsonIS_CBOR(pJson) ? xCborFormatF64((u8_t *) caBuf, F64) : xJsonFormatF64(caBuf, F64, pJson->Decimals));
+}
+
+void ecJsonPutStr(json_obj_t * pJson, const char * pcStr) {
+	if (*pcStr)
+		ecJsonAddString(pJson, pcStr, 0);
+	else if (jsonIS_CBOR(pJson))
+		ecCborAddHead(pJson, cborMAJOR_TSTR, 0);
+	else
+		ecJsonWrite(pJson, "\"\"", 2);
 }
 
 /**
@@ -247,16 +637,69 @@ int	ecJsonAddKeyValue(json_obj_t * pJson, const char * pKey, px_t pX, jform_t jF
 int	ecJsonCloseObject(json_obj_t * pJson) {
 	if (pJson->child)
 		ecJsonCloseObject(pJson->child);				// recurse to close the child first..
-	IF_myASSERT(debugPARAM, pJson->obj_nest == 0);		// should be zero after recursing to lowest level
-	ecJsonAddChar(pJson, CHR_R_CURLY);					// close the object
-	if (pJson->type == jsonTYPE_ARRAY)
-		ecJsonAddChar(pJson, CHR_R_SQUARE);				// close the array
+	IF_myASSERT(debugPARAM, pJson->obj_nest == 0 && pJson->arr_nest == 0);	// should be zero after recursing to lowest level
+	if (pJson->type == jsonTYPE_LIST) {
+		ecJsonAddMark(pJson, CHR_R_SQUARE, cborBREAK);	// close the open array
+	} else {
+		ecJsonAddMark(pJson, CHR_R_CURLY, cborBREAK);	// close the object
+		if (pJson->type == jsonTYPE_ARRAY)
+			ecJsonAddMark(pJson, CHR_R_SQUARE, cborBREAK);	// close the array
+	}
 	if (pJson->parent) {								// is this a child to a parent ?
-		pJson->parent->obj_nest--;						// adjust the nesting level of the parent
+		jsonSTAT_DOC(pJson->parent, StatBytes, pJson->StatBytes);
+		jsonSTAT_DOC(pJson->parent, StatEscapes, pJson->StatEscapes);
+		if (pJson->type == jsonTYPE_LIST)				// adjust the nesting level of the parent
+			pJson->parent->arr_nest--;
+		else
+			pJson->parent->obj_nest--;
 		pJson->parent->child = 0;						// reset parent to child link
 		pJson->parent = 0;								// reset child to parent link
+	} else {
+		jsonSTAT_ADD(WriteDocs, 1);
+		#if (jsonSTATS == 1)
+		vJsonStatsHist(&sJsonStats.DocBytes, pJson->StatBytes);
+		vJsonStatsHist(&sJsonStats.DocEscapes, pJson->StatEscapes);
+		#endif
+		if (pJson->psCtx && pJson->psCtx->hdlrSink)	// root closed, flush remainder
+			ecJsonCtxFlush(pJson->psCtx);
 	}
-	return  erSUCCESS;
+	return ecJsonStatus(pJson);
+}
+
+int ecJsonCloseArray(json_obj_t * pArr) {
+	IF_myASSERT(debugPARAM, pArr->type == jsonTYPE_LIST);
+	return ecJsonCloseObject(pArr);
+}
+
+/**
+ * @brief	Initialise new Json structure and write the opening '{' (or '[' if jsonTYPE_LIST) to the stream
+ */
+static void ecJsonOpen(json_obj_t * pJson, ubuf_t * psUB, json_ctx_t * psCtx, u8_t Type) {
+	pJson->parent = pJson->child = 0;
+	pJson->psUB = psUB;
+	pJson->psCtx = psCtx;
+	pJson->val_count = 0;
+	pJson->obj_nest = 0;
+	pJson->arr_nest = 0;
+	pJson->f_Full = 0;
+	pJson->type = Type;
+	#if (jsonSTATS == 1)
+	pJson->StatBytes = pJson->StatEscapes = 0;
+	#endif
+	if (Type == jsonTYPE_LIST)
+		ecJsonAddMark(pJson, CHR_L_SQUARE, cborARRAY_INDEF);
+	else
+		ecJsonAddMark(pJson, CHR_L_CURLY, cborMAP_INDEF);
+}
+
+int ecJsonOpenArray(json_obj_t * pJson, const char * pKey, json_obj_t * pArr) {
+	IF_myASSERT(debugPARAM, halMemorySRAM(pJson) && halMemorySRAM(pArr));
+	IF_myASSERT(debugPARAM, (pJson->type == jsonTYPE_LIST) == (pKey == NULL));
+	IF_myASSERT(debugPARAM, pJson->child == NULL);
+	ecJsonAddKey(pJson, pKey, 0);
+	pJson->val_count++;
+	ecJsonAddChild(pJson, pArr, jsonTYPE_LIST);
+	return ecJsonStatus(pArr);
 }
 
 /**
@@ -267,11 +710,49 @@ int	ecJsonCloseObject(json_obj_t * pJson) {
  */
 int	ecJsonCreateObject(json_obj_t * pJson, ubuf_t * psUB) {
 	IF_myASSERT(debugPARAM, halMemorySRAM(pJson) && halMemorySRAM(psUB));
-	pJson->parent = pJson->child = 0;
-	pJson->psUB = psUB;
-	pJson->val_count = 0;
-	pJson->obj_nest = 0;
-	pJson->type = jsonTYPE_NULL;
-	ecJsonAddChar(pJson, CHR_L_CURLY);
-	return erSUCCESS;
+	ecJsonOpen(pJson, psUB, NULL, jsonTYPE_NULL);
+	pJson->Decimals = ecJsonDecimals;					// legacy defaults, read once per document
+	pJson->f_Trace = OPT_GET(dbgJSONwr) ? 1 : 0;
+	return ecJsonStatus(pJson);
+}
+
+int	ecJsonCreateObjectCtx(json_obj_t * pJson, json_ctx_t * psCtx) {
+	IF_myASSERT(debugPARAM, halMemorySRAM(pJson) && halMemorySRAM(psCtx));
+	ecJsonOpen(pJson, psCtx->psUB, psCtx, jsonTYPE_NULL);
+	pJson->Decimals = psCtx->Decimals;					// no global state on the context path
+	pJson->f_Trace = psCtx->fTrace;
+	return ecJsonStatus(pJson);
+}
+
+void vJsonCtxMeasure(json_ctx_t * psCtx) {
+	memset(psCtx, 0, sizeof(json_ctx_t));
+	psCtx->Decimals = jsonDECIMALS_DEFAULT;
+	psCtx->fMeasure = 1;
+}
+
+void vJsonCtxInit(json_ctx_t * psCtx, ubuf_t * psUB, size_t szSeg) {
+	IF_myASSERT(debugPARAM, halMemorySRAM(psUB));
+	memset(psCtx, 0, sizeof(json_ctx_t));
+	psCtx->Decimals = jsonDECIMALS_DEFAULT;
+	psCtx->psUB = psUB;
+	psCtx->szSeg = szSeg;
+}
+
+void vJsonCtxSink(json_ctx_t * psCtx, ubuf_t * psUB, json_sink_t hdlrSink, void * pvArg, size_t HighWater) {
+	IF_myASSERT(debugPARAM, psUB == NULL || halMemorySRAM(psUB));
+	memset(psCtx, 0, sizeof(json_ctx_t));
+	psCtx->Decimals = jsonDECIMALS_DEFAULT;
+	psCtx->psUB = psUB;
+	psCtx->hdlrSink = hdlrSink;
+	psCtx->pvSink = pvArg;
+	psCtx->HighWater = HighWater;
+}
+
+void vJsonCtxRelease(json_ctx_t * psCtx) {
+	while (psCtx->psHead) {
+		json_seg_t * psSeg = psCtx->psHead;
+		psCtx->psHead = psSeg->psNext;
+		free(psSeg);
+	}
+	psCtx->psTail = NULL;
 }
@@ -7,6 +7,8 @@
 #include "complex_vars.h"
 #include "x_ubuf.h"
 #include "errors_events.h"
+#include "numberX.h"
+#include "statsX.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -43,30 +45,168 @@ enum {
     erJSON_UNDEF,
 } ;
 
-enum { jsonTYPE_NULL, jsonTYPE_ARRAY };
+enum { jsonFMT_JSON, jsonFMT_CBOR };						// json_ctx_t output format
+
+enum { jsonTYPE_NULL, jsonTYPE_ARRAY, jsonTYPE_LIST };	// object, object in [ ], open array
 
 // ############################################ structures #########################################
 
+typedef struct json_seg_t {
+	struct json_seg_t * psNext;
+	size_t Used;
+	size_t Size;
+	char Buf[];
+} json_seg_t;
+
+/**
+ * @brief	output sink, eg socket, file or TLS write
+ * @return	number of bytes accepted (1 to szBuf), 0 or < 0 on error
+ * @note	Short writes are retried with the remainder until the whole block is accepted
+ */
+typedef int (* json_sink_t)(void * pvArg, const char * pcBuf, size_t szBuf);
+
+/**
+ * @brief	Output context, shared by all objects of a document
+ * @note	Document = psUB contents followed by the chained segments (if any) in order
+ */
+typedef struct json_ctx_t {
+	ubuf_t * psUB;										// output buffer, NULL if measuring
+	size_t Count;										// bytes written, or measured, in total
+	json_seg_t * psHead;								// chained overflow segments
+	json_seg_t * psTail;
+	size_t szSeg;										// minimum size of overflow segment, 0 = no chaining
+	json_sink_t hdlrSink;								// flush target, NULL if none
+	void * pvSink;										// argument passed to hdlrSink
+	size_t HighWater;									// flush psUB when this level reached
+	u8_t Format;										// jsonFMT_JSON (default) or jsonFMT_CBOR, set after init
+	i8_t Decimals;										// float decimals, jsonDECIMALS_DEFAULT after init
+	union {
+		struct {
+			u8_t fMeasure:1;							// count only, nothing written
+			u8_t fFull:1;								// output truncated, buffer full or sink error
+			u8_t fTrace:1;								// trace ecJsonAddKeyValue() calls, set after init
+		};
+		u8_t Flags;
+	};
+} json_ctx_t;
+
 typedef struct json_obj_t {
 	struct json_obj_t *	parent;
 	struct json_obj_t *	child;
     ubuf_t * psUB;
+    json_ctx_t * psCtx;							// NULL if writing directly to psUB
+    u32_t val_count;			// values (or array elements) written so far
     struct {
     	u8_t obj_nest:4;			// count OBJECT nesting level in this object
     	u8_t arr_nest:4;			// count ARRAY nesting level in this object
-    	u8_t val_count:8;			// max 255 values per object
     	u8_t f_NoSep:1;				// once off separator skip..
+    	u8_t f_Full:1;				// psUB full, output truncated
+    	u8_t f_Trace:1;				// trace ecJsonAddKeyValue() calls
     	u8_t type;
+    	i8_t Decimals;				// float decimals, inherited by child objects/arrays
     };
+    #if (jsonSTATS == 1)
+    u32_t StatBytes;			// bytes written by this object & its closed children
+    u32_t StatEscapes;			// escapes written by this object & its closed children
+    #endif
 } json_obj_t;
 
 // ####################################### global functions ########################################
 
+/**
+ * @brief	Set the float decimals default for roots created with ecJsonCreateObject()
+ * @note	Read once when the root is created, roots created with ecJsonCreateObjectCtx() use psCtx->Decimals
+ */
 void ecJsonSetDecimals(int xNumber);
+
+/**
+ * @brief	Set the float decimals of an object/array, and of children opened after the call
+ */
+void ecJsonSetDecimalsObj(json_obj_t * pJson, int xNumber);
+
 int	ecJsonAddKeyValue(json_obj_t * pJson, const char * pKey, px_t pValue, jform_t jForm, cvi_e cvI, size_t xArrSize);
 int	ecJsonCloseObject(json_obj_t * pJson);
 int	ecJsonCreateObject(json_obj_t * pJson, ubuf_t * psUB);
 
+/**
+ * @brief	Add a key : [column] pair, values Stride bytes apart, eg 1 member of each struct in an array
+ * @note	cvI is cvU08 -> cvF64 or cvSXX (inline char array members), key escaped as for ecJsonAddKeyValue()
+ */
+int ecJsonAddKeyColumn(json_obj_t * pJson, const char * pKey, px_t pX, cvi_e cvI, size_t Sz, size_t Stride);
+
+/**
+ * @brief	Open a new array, as a child of an object or another array
+ * @param	pJson - parent object or array
+ * @param	pKey - key if parent is an object, NULL if parent is an array
+ * @param	pArr - array control structure to initialise, values added with pKey = NULL
+ * @return	erSUCCESS or erJSON_BUF_FULL
+ * @note	Only one child (array or object) may be open at a time, close it before adding to the parent
+ */
+int ecJsonOpenArray(json_obj_t * pJson, const char * pKey, json_obj_t * pArr);
+
+/**
+ * @brief	Close an array opened with ecJsonOpenArray(), closing any open children first
+ */
+int ecJsonCloseArray(json_obj_t * pArr);
+
+/**
+ * @brief	Initialise a context to measure the size of a document, nothing is written
+ * @note	Run the same ecJsonCreateObjectCtx/AddKeyValue/CloseObject sequence, size in psCtx->Count
+ */
+void vJsonCtxMeasure(json_ctx_t * psCtx);
+
+/**
+ * @brief	Initialise a context to write to a buffer, optionally chaining overflow segments
+ * @note	Per document configuration (Format, Decimals, fTrace) lives in the context, set after init
+ * @param	szSeg - minimum size of each overflow segment allocated, 0 to disable chaining
+ */
+void vJsonCtxInit(json_ctx_t * psCtx, ubuf_t * psUB, size_t szSeg);
+
+/**
+ * @brief	Initialise a context to stream via a small buffer to a sink
+ * @param	psUB - buffer (initially empty) used to batch output, NULL for unbuffered writes
+ * @param	HighWater - flush the buffer to the sink once it holds this many bytes, 0 = when full
+ * @note	Remaining output is flushed when the root object is closed
+ */
+void vJsonCtxSink(json_ctx_t * psCtx, ubuf_t * psUB, json_sink_t hdlrSink, void * pvArg, size_t HighWater);
+
+/**
+ * @brief	Flush buffered output to the sink
+ * @return	erSUCCESS or erJSON_BUF_FULL if the sink failed
+ */
+int ecJsonCtxFlush(json_ctx_t * psCtx);
+
+/**
+ * @brief	Free all chained overflow segments
+ */
+void vJsonCtxRelease(json_ctx_t * psCtx);
+
+/**
+ * @brief	Initialise root Json structure using an output context, and write the opening '{'
+ * @return	erSUCCESS or erJSON_BUF_FULL
+ */
+int	ecJsonCreateObjectCtx(json_obj_t * pJson, json_ctx_t * psCtx);
+
+/**
+ * @brief	Status of the output, shared by all objects of a context
+ * @return	erSUCCESS or erJSON_BUF_FULL if output truncated
+ */
+int ecJsonStatus(json_obj_t * pJson);
+
+/**
+ * @brief	Direct (type specific) writers, no jform_t/cvi_e dispatch, used by schemaX encoders
+ * @note	ecJsonPutKey() handles the separator and MUST precede each value, key is NOT escaped
+ * @note	ecJsonPutItem() does the same for each element of an array opened with ecJsonOpenArray()
+ * @note	No status returned, check ecJsonStatus() once after a sequence of writes
+ */
+void ecJsonPutKey(json_obj_t * pJson, const char * pcKey, size_t szKey);
+void ecJsonPutItem(json_obj_t * pArr);
+void ecJsonPutU64(json_obj_t * pJson, u64_t U64);
+void ecJsonPutI64(json_obj_t * pJson, i64_t I64);
+void ecJsonPutF32(json_obj_t * pJson, f32_t F32);
+void ecJsonPutF64(json_obj_t * pJson, f64_t F64);
+void ecJsonPutStr(json_obj_t * pJson, const char * pcStr);
+
 #ifdef __cplusplus
 }
 #endif